@@ -1,7 +1,10 @@
 #include<bits/stdc++.h>
+#include<fcntl.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include<unistd.h>
 using namespace std;
 typedef pair<int,int> Pair;
-typedef pair<double,pair<int,int>> pPair;
 //class to define cell and its parameters like coordinates of parents cells and costs
 struct cell{
 
@@ -9,71 +12,719 @@ struct cell{
    int parent_j;
    double f,g,h;
 };
-//priority queue implemented as a min heap to find out minimum f value from 2 nodes in less time i.e. is logn
-class PriorityQueue{
+/*indexed d-ary min heap used as the open list
+entries are flat cell indices,pos[] remembers where each cell sits in the heap
+so a better path to a cell already on the open list lowers its key in place
+instead of pushing a duplicate entry
+a 4-ary heap is shallower than a binary one and its children share a cache line
+*/
+template<class Key,int D=4>
+class IndexedDaryHeap{
 private:
-   vector<pair<double,Pair>> heap;
-   //function to maintain condition of min heap i.e.every node should be less than or equal to its descendent
-   void heapifyup(int index){
-    while(index>0&&heap[(index-1)/2].first>heap[index].first){
-        swap(heap[index],heap[(index-1)/2]);
-        index=(index-1)/2;
-
+   struct entry{
+    Key key;
+    int index;
+   };
+   vector<entry> heap;
+   vector<int> pos;//position of every cell in heap,-1 if not on it
+   //function to move an entry up until its parent is not larger
+   void siftup(int hole,entry e){
+    while(hole>0){
+        int parent=(hole-1)/D;
+        if(!(e.key<heap[parent].key)) break;
+        heap[hole]=heap[parent];
+        pos[heap[hole].index]=hole;
+        hole=parent;
     }
+    heap[hole]=e;
+    pos[e.index]=hole;
    }
-   //function to maintain heap property when an element is removed
-   /*when an element is deleted the bottom element is shifted at top so min-heap condition is violated hence 
-   be restored so we use this function
-   */
-   void heapifydown(int index){
-    int smallest=index;
-    int left=2*index+1;
-    int right=2*index+2;
-    if(left<heap.size()&&heap[left].first<heap[smallest].first){
-        smallest=left;
+   //function to move an entry down until no child is smaller,iterative so deep heaps cost no stack
+   void siftdown(int hole,entry e){
+    int n=heap.size();
+    while(true){
+        int first=hole*D+1;
+        if(first>=n) break;
+        int last=min(first+D,n);
+        int best=first;
+        for(int c=first+1;c<last;c++){
+            if(heap[c].key<heap[best].key) best=c;
+        }
+        if(!(heap[best].key<e.key)) break;
+        heap[hole]=heap[best];
+        pos[heap[hole].index]=hole;
+        hole=best;
+    }
+    heap[hole]=e;
+    pos[e.index]=hole;
+   }
+public:
+   static const bool FIXEDPOINT=false;
+   explicit IndexedDaryHeap(int cells=0):pos(cells,-1){}
+   //function to make room for cell indices below cells
+   void resize(int cells){
+    pos.assign(cells,-1);
+    heap.clear();
+   }
+   bool empty() const{
+    return heap.empty();
+   }
+   int size() const{
+    return heap.size();
+   }
+   int capacity() const{
+    return pos.size();
+   }
+   bool contains(int index) const{
+    return pos[index]>=0;
+   }
+   //function to view the key of the minimum entry
+   Key topkey() const{
+    return heap[0].key;
+   }
+   int top() const{
+    return heap[0].index;
+   }
+   //function to insert a cell or lower its key if it is already on the heap
+   void push(int index,Key key){
+    int p=pos[index];
+    if(p<0){
+        heap.push_back(entry{key,index});
+        siftup(heap.size()-1,heap.back());
     }
-    if(right<heap.size()&&heap[index].first>heap[right].first){
-        smallest=right;
+    else if(key<heap[p].key){
+        siftup(p,entry{key,index});
     }
-    if(smallest!=index){
-        swap(heap[index],heap[smallest]);
-        heapifydown(smallest);
+   }
+   //function to change the key of a cell on the heap in either direction
+   void update(int index,Key key){
+    int p=pos[index];
+    if(p<0){
+        push(index,key);
+        return;
     }
-
+    if(key<heap[p].key) siftup(p,entry{key,index});
+    else siftdown(p,entry{key,index});
    }
-public:
-//function to push cost value and coordinates of cell into heap
-   void push(pair<double,Pair> val){
-    heap.push_back(val);
-    heapifyup(heap.size()-1);
-   }
-   //function to remove the pair of cost value and coordinates of cell from min heap
-   void pop(){
-    heap[0]=heap.back();
+   //function to remove the minimum entry and return its cell index
+   int pop(){
+    int index=heap[0].index;
+    pos[index]=-1;
+    entry last=heap.back();
     heap.pop_back();
-    heapifydown(0);
-
+    if(!heap.empty()) siftdown(0,last);
+    return index;
    }
-   //fucntiom to view the top element i.e. min element of heap
-   pair<double,Pair>> top(){
-    if(!heap.empty()) return heap[0];
-    return {FLT_MAX,{-1,-1}};//return invalid if empty
-
-
+   //function to take any cell off the heap
+   void remove(int index){
+    int p=pos[index];
+    if(p<0) return;
+    pos[index]=-1;
+    entry last=heap.back();
+    heap.pop_back();
+    if(p==(int)heap.size()) return;
+    if(last.key<heap[p].key) siftup(p,last);
+    else siftdown(p,last);
    }
-   //function to check if heap is empty or not
-   bool empty(){
-    
-    if(heap.empty()) return true;
-    return false;
+   //function to empty the heap,costs only as much as the entries left on it
+   void clear(){
+    for(const entry &e:heap) pos[e.index]=-1;
+    heap.clear();
+   }
+   //function to call visit(index) for every cell on the heap,in no particular order
+   template<class Visit>
+   void foreach(Visit visit) const{
+    for(const entry &e:heap) visit(e.index);
+   }
+   //function to give every entry the key keyof(index) and restore heap order bottom up in O(n)
+   template<class KeyOf>
+   void rekey(KeyOf keyof){
+    for(entry &e:heap) e.key=keyof(e.index);
+    for(int hole=(int)heap.size()/D;hole>=0;hole--){
+        if(hole<(int)heap.size()) siftdown(hole,heap[hole]);
+    }
+   }
+};
+/*radix heap over integer keys used as a bucket queue open list
+A* with a consistent heuristic never pushes a key below the last one popped,
+so keys are bucketed by the highest bit in which they differ from the last popped key
+and each entry moves down at most 64 buckets over its lifetime
+costs are kept in fixed point (FIXEDSCALE units per cell) so f values are exact integers,
+cells on the queue can still lower their key in place through pos[]
+*/
+class RadixQueue{
+private:
+   struct entry{
+    unsigned long long key;
+    int index;
+   };
+   vector<entry> buckets[65];
+   vector<pair<int,int>> pos;//bucket and slot of every cell,bucket -1 if not queued
+   unsigned long long last;
+   int count;
+   int bucketof(unsigned long long key) const{
+    if(key==last) return 0;
+    return 64-__builtin_clzll(key^last);
+   }
+   void place(entry e){
+    int b=bucketof(e.key);
+    pos[e.index]={b,(int)buckets[b].size()};
+    buckets[b].push_back(e);
+   }
+   void takeout(int index){
+    pair<int,int> p=pos[index];
+    vector<entry> &bucket=buckets[p.first];
+    bucket[p.second]=bucket.back();
+    pos[bucket[p.second].index].second=p.second;
+    bucket.pop_back();
+    pos[index]={-1,-1};
+   }
+public:
+   static const bool FIXEDPOINT=true;
+   static const int FIXEDSCALE=1<<16;
+   explicit RadixQueue(int cells=0):pos(cells,{-1,-1}),last(0),count(0){}
+   void resize(int cells){
+    pos.assign(cells,{-1,-1});
+    for(auto &b:buckets) b.clear();
+    last=0;
+    count=0;
+   }
+   bool empty() const{
+    return count==0;
+   }
+   int size() const{
+    return count;
+   }
+   int capacity() const{
+    return pos.size();
+   }
+   bool contains(int index) const{
+    return pos[index].first>=0;
+   }
+   //function to convert a fixed point cost into its integer key
+   static unsigned long long tokey(double cost){
+    return (unsigned long long)llround(cost*FIXEDSCALE);
+   }
+   //function to insert a cell or lower its key if it is already queued
+   void push(int index,double cost){
+    unsigned long long key=tokey(cost);
+    if(pos[index].first>=0){
+        pair<int,int> p=pos[index];
+        if(key>=buckets[p.first][p.second].key) return;
+        takeout(index);
+        count--;
+    }
+    place(entry{key,index});
+    count++;
+   }
+   //function to remove a cell with the minimum key and return its index
+   int pop(){
+    if(buckets[0].empty()){
+        int b=1;
+        while(buckets[b].empty()) b++;
+        //the smallest key in the first non empty bucket becomes the new reference point
+        //and every entry of that bucket lands in a strictly lower bucket
+        unsigned long long smallest=buckets[b][0].key;
+        for(const entry &e:buckets[b]) smallest=min(smallest,e.key);
+        last=smallest;
+        vector<entry> moved;
+        moved.swap(buckets[b]);
+        for(const entry &e:moved) place(e);
+    }
+    entry e=buckets[0].back();
+    buckets[0].pop_back();
+    pos[e.index]={-1,-1};
+    count--;
+    return e.index;
+   }
+   //function to empty the queue and restart keys from zero
+   void clear(){
+    for(auto &b:buckets){
+        for(const entry &e:b) pos[e.index]={-1,-1};
+        b.clear();
+    }
+    last=0;
+    count=0;
+   }
+};
+/*compact binary map that is memory mapped read only
+layout (native byte order):a 64 byte BITGRIDHEADER,then ROW rows of passability bits
+(bit j of a row is cell j,1-unblocked) padded to whole 64 bit words,then optionally ROW rows
+of one traversal cost byte per cell padded to 64 bytes
+a 10k x 10k map is 12.5 MB of bits instead of 400 MB of ints and opening it is a single mmap,
+pages are only read from disk when a search touches them
+*/
+struct BITGRIDHEADER{
+   char magic[8];
+   uint32_t version;
+   uint32_t rows,cols;
+   uint32_t rowwords;//64 bit words per row of the passability plane
+   uint32_t costpitch;//bytes per row of the cost plane,0 if the map has no costs
+   uint32_t reserved;
+   uint64_t bitsoffset,costoffset;
+   char pad[16];
+};
+static_assert(sizeof(BITGRIDHEADER)==64,"map header must stay 64 bytes");
+static const char BITGRIDMAGIC[8]={'O','P','T','I','G','R','I','D'};
+class BITGRID{
+public:
+   int ROW,COL;
+   int rowwords,costpitch;
+   const unsigned long long *bits;
+   const unsigned char *costs;
+   void *mapping;
+   size_t mappedsize;
+   BITGRID():ROW(0),COL(0),rowwords(0),costpitch(0),bits(nullptr),costs(nullptr),mapping(nullptr),mappedsize(0){}
+   BITGRID(const BITGRID&)=delete;
+   BITGRID& operator=(const BITGRID&)=delete;
+   ~BITGRID(){
+    close();
+   }
+   void close(){
+    if(mapping) munmap(mapping,mappedsize);
+    mapping=nullptr;
+    bits=nullptr;
+    costs=nullptr;
+   }
+   //function to map a map file,returns false and says why in error if it is not a valid map
+   bool open(const string&path,string&error){
+    close();
+    int fd=::open(path.c_str(),O_RDONLY);
+    if(fd<0){
+        error="cannot open "+path;
+        return false;
+    }
+    struct stat st;
+    if(fstat(fd,&st)!=0||st.st_size<(off_t)sizeof(BITGRIDHEADER)){
+        ::close(fd);
+        error=path+" is too small to be a map";
+        return false;
+    }
+    mappedsize=st.st_size;
+    mapping=mmap(nullptr,mappedsize,PROT_READ,MAP_SHARED,fd,0);
+    ::close(fd);
+    if(mapping==MAP_FAILED){
+        mapping=nullptr;
+        error="cannot map "+path;
+        return false;
+    }
+    const BITGRIDHEADER &h=*(const BITGRIDHEADER*)mapping;
+    uint64_t bitsend=h.bitsoffset+(uint64_t)h.rows*h.rowwords*8;
+    uint64_t costend=h.costoffset+(uint64_t)h.rows*h.costpitch;
+    if(memcmp(h.magic,BITGRIDMAGIC,8)!=0||h.version!=1||h.rowwords<(h.cols+63)/64
+        ||h.bitsoffset%8!=0||bitsend>mappedsize||(h.costpitch>0&&(h.costpitch<h.cols||costend>mappedsize))){
+        close();
+        error=path+" is not a valid map";
+        return false;
+    }
+    ROW=h.rows;
+    COL=h.cols;
+    rowwords=h.rowwords;
+    costpitch=h.costpitch;
+    bits=(const unsigned long long*)((const char*)mapping+h.bitsoffset);
+    costs=costpitch?(const unsigned char*)mapping+h.costoffset:nullptr;
+    return true;
+   }
+   bool isfree(int row,int col) const{
+    return (bits[(size_t)row*rowwords+(col>>6)]>>(col&63))&1;
+   }
+   //function to read the traversal cost byte of a cell,1 if the map has no cost plane
+   int cost(int row,int col) const{
+    return costs?costs[(size_t)row*costpitch+col]:1;
+   }
+   //function to write a grid (and optionally a cost per cell,clamped to 1..255) as a map file
+   static bool write(const string&path,const vector<vector<int>>&grid,int ROW,int COL,const vector<vector<int>>*cellcosts,string&error){
+    BITGRIDHEADER h;
+    memset(&h,0,sizeof(h));
+    memcpy(h.magic,BITGRIDMAGIC,8);
+    h.version=1;
+    h.rows=ROW;
+    h.cols=COL;
+    h.rowwords=(COL+63)/64;
+    h.costpitch=cellcosts?(COL+63)/64*64:0;
+    h.bitsoffset=sizeof(h);
+    h.costoffset=h.bitsoffset+(uint64_t)ROW*h.rowwords*8;
+    FILE *out=fopen(path.c_str(),"wb");
+    if(!out){
+        error="cannot create "+path;
+        return false;
+    }
+    bool ok=fwrite(&h,sizeof(h),1,out)==1;
+    vector<unsigned long long> row(h.rowwords);
+    for(int i=0;i<ROW&&ok;i++){
+        fill(row.begin(),row.end(),0ULL);
+        for(int j=0;j<COL;j++) if(grid[i][j]==1) row[j>>6]|=1ULL<<(j&63);
+        ok=fwrite(row.data(),8,row.size(),out)==row.size();
+    }
+    vector<unsigned char> costrow(h.costpitch);
+    for(int i=0;i<ROW&&ok&&cellcosts;i++){
+        fill(costrow.begin(),costrow.end(),0);
+        for(int j=0;j<COL;j++) costrow[j]=(unsigned char)min(255,max(1,(*cellcosts)[i][j]));
+        ok=fwrite(costrow.data(),1,costrow.size(),out)==costrow.size();
+    }
+    if(fclose(out)!=0) ok=false;
+    if(!ok) error="cannot write "+path;
+    return ok;
+   }
+};
+/*a text grid together with a traversal cost per cell,the in memory counterpart of a map with a cost plane
+costs are clamped to 1..255 like BITGRID::write does,so a cost is never below the unit step
+the straight line heuristics assume
+*/
+class COSTGRID{
+public:
+   const vector<vector<int>> &grid;
+   int ROW,COL;
+   vector<unsigned char> costs;
+   COSTGRID(const vector<vector<int>>&grid,const vector<vector<int>>&cellcosts,int row,int col)
+      :grid(grid),ROW(row),COL(col),costs((size_t)row*col){
+    for(int i=0;i<row;i++){
+        for(int j=0;j<col;j++) costs[(size_t)i*col+j]=(unsigned char)min(255,max(1,cellcosts[i][j]));
+    }
+   }
+   int cost(int row,int col) const{
+    return costs[(size_t)row*COL+col];
+   }
+};
+//functions to check a cell of any grid representation,1-unblocked
+inline bool isfreecell(const vector<vector<int>>&grid,int row,int col){
+   return grid[row][col]==1;
+}
+inline bool isfreecell(const BITGRID&grid,int row,int col){
+   return grid.isfree(row,col);
+}
+inline bool isfreecell(const COSTGRID&grid,int row,int col){
+   return grid.grid[row][col]==1;
+}
+//functions to read the cost of entering a cell,a step costs its length times this
+inline int cellcost(const vector<vector<int>>&,int,int){
+   return 1;
+}
+inline int cellcost(const BITGRID&grid,int row,int col){
+   return grid.cost(row,col);
+}
+inline int cellcost(const COSTGRID&grid,int row,int col){
+   return grid.cost(row,col);
+}
+//functions to tell whether step costs can differ between cells,jump point search needs them uniform
+inline bool hascellcosts(const vector<vector<int>>&){
+   return false;
+}
+inline bool hascellcosts(const BITGRID&grid){
+   return grid.costs!=nullptr;
+}
+inline bool hascellcosts(const COSTGRID&){
+   return true;
+}
+/*packed occupancy bitmap used by jump point search,1 bit per cell and 1 means blocked
+every line (a row,or a column in the transposed copy) is padded with PAD blocked bits
+on both ends and there is an all blocked line before the first and after the last one,
+so a scan never needs a bounds check and falls off the grid onto a blocked bit
+*/
+struct JumpBitmap{
+   static const int PAD=128;
+   int lines,length,words;
+   vector<unsigned long long> bits;
+   //function to pack the grid,transposed makes every line a column instead of a row
+   template<class Grid>
+   void build(const Grid&grid,int ROW,int COL,bool transposed){
+    lines=transposed?COL:ROW;
+    length=transposed?ROW:COL;
+    words=(length+2*PAD+63)/64;
+    bits.assign((size_t)(lines+2)*words,~0ULL);
+    for(int l=0;l<lines;l++){
+        for(int p=0;p<length;p++){
+            if(transposed?isfreecell(grid,p,l):isfreecell(grid,l,p)) bits[(size_t)(l+1)*words+((p+PAD)>>6)]&=~(1ULL<<((p+PAD)&63));
+        }
+    }
+   }
+   //function to pack the rows of a mapped grid,PAD is whole words so rows are copied word by word
+   void build(const BITGRID&grid,int ROW,int COL,bool transposed){
+    if(transposed){
+        build<BITGRID>(grid,ROW,COL,true);
+        return;
+    }
+    lines=ROW;
+    length=COL;
+    words=(length+2*PAD+63)/64;
+    bits.assign((size_t)(lines+2)*words,~0ULL);
+    for(int l=0;l<lines;l++){
+        unsigned long long *line=&bits[(size_t)(l+1)*words+PAD/64];
+        for(int w=0;w<grid.rowwords;w++) line[w]=~grid.bits[(size_t)l*grid.rowwords+w];
+    }
+   }
+   //function to check one bit,line can be -1..lines and pos can run PAD cells past either end
+   bool blocked(int line,int pos) const{
+    int b=pos+PAD;
+    return (bits[(size_t)(line+1)*words+(b>>6)]>>(b&63))&1;
+   }
+   //function to read the 64 bits of a line starting at pos,bit k is cell pos+k
+   unsigned long long window(int line,int pos) const{
+    const unsigned long long *w=&bits[(size_t)(line+1)*words];
+    int b=pos+PAD;
+    int off=b&63;
+    if(off==0) return w[b>>6];
+    return (w[b>>6]>>off)|(w[(b>>6)+1]<<(64-off));
+   }
+   /*function to jump along a line from pos in direction step(+1 or -1)
+   stops on the first cell that has a forced neighbour on either adjacent line
+   i.e. the adjacent cell is blocked and the one after it is free,or on the goal
+   returns that cell or -1 if a blocked cell comes first,64 cells are tested per word
+   */
+   int scan(int line,int pos,int step,int goal) const{
+    if(step>0){
+        for(int c=pos;;c+=64){
+            unsigned long long own=window(line,c);
+            unsigned long long stop=own
+                |(window(line-1,c)&~window(line-1,c+1))
+                |(window(line+1,c)&~window(line+1,c+1));
+            if(goal>=c&&goal<c+64) stop|=1ULL<<(goal-c);
+            if(stop){
+                int k=__builtin_ctzll(stop);
+                return (own>>k)&1?-1:c+k;
+            }
+        }
+    }
+    for(int c=pos;;c-=64){
+        int base=c-63;
+        unsigned long long own=window(line,base);
+        unsigned long long stop=own
+            |(window(line-1,base)&~window(line-1,base-1))
+            |(window(line+1,base)&~window(line+1,base-1));
+        if(goal>=base&&goal<=c) stop|=1ULL<<(goal-base);
+        if(stop){
+            int k=63-__builtin_clzll(stop);
+            return (own>>k)&1?-1:base+k;
+        }
+    }
    }
-
-
 };
+//function to print a path as (i,j)->(i,j)->...
+void printpath(const vector<Pair>&path){
+    cout<<"\nthe path is";
+    for(size_t k=0;k<path.size();k++){
+        cout<<"("<<path[k].first<<","<<path[k].second<<")";
+        if(k+1<path.size())cout<<"->";
+    }
+    cout<<endl;
+}
+//one of the 8 moves from a cell,with its step cost
+struct direction{
+   int di,dj;
+   double cost;
+};
+static const direction DIRS[8]={
+   {0,1,1.0},{0,-1,1.0},{-1,0,1.0},{1,0,1.0},
+   {-1,-1,M_SQRT2},{-1,1,M_SQRT2},{1,1,M_SQRT2},{1,-1,M_SQRT2}
+};
+/*landmark (ALT) lower bounds for grid searches
+a few landmark cells are picked far apart,each one the cell farthest from the landmarks picked
+before it,and the cost from every landmark to every cell is stored once
+by the triangle inequality d(L,to)-d(L,from) is then a lower bound on the cost of going from
+from to to for every landmark L,and so is its absolute value when steps cost the same both ways
+which holds on grids without per cell costs,the bound is the largest over all landmarks
+distances are floats stored cell-major and padded to a multiple of LANES landmarks,so the
+distances of one cell are contiguous and the bound is taken over LANES landmarks per vector
+instruction,a float only keeps 24 bits so every bound is lowered by the rounding it can carry
+*/
+class GRIDLANDMARKS{
+public:
+   static const int LANES=8;
+   int ROW,COL;
+   int count,stride;
+   bool symmetric;
+   vector<Pair> cells;
+   vector<float> distance;//distance[cell*stride+l],-1 if the cell cannot be reached from landmark l
+   GRIDLANDMARKS():ROW(0),COL(0),count(0),stride(0),symmetric(true){}
+   //function to pick k landmarks on the grid and compute the cost from each of them to every cell
+   template<class Grid>
+   void build(const Grid&grid,int row,int col,int k){
+    ROW=row;
+    COL=col;
+    symmetric=!hascellcosts(grid);
+    cells.clear();
+    stride=(k+LANES-1)/LANES*LANES;
+    distance.assign((size_t)ROW*COL*stride,0.0f);
+    //nearest[c] is the cost to c from the closest landmark picked so far
+    vector<double> nearest((size_t)ROW*COL,DBL_MAX),dist;
+    int first=-1;
+    for(int c=0;c<ROW*COL&&first<0;c++){
+        if(isfreecell(grid,c/COL,c%COL)) first=c;
+    }
+    if(first<0) return;
+    //the first landmark is the cell farthest from an arbitrary free cell
+    costsfrom(grid,first,dist);
+    int next=farthest(grid,dist);
+    for(count=0;count<k&&next>=0;count++){
+        cells.push_back(make_pair(next/COL,next%COL));
+        costsfrom(grid,next,dist);
+        for(size_t c=0;c<dist.size();c++){
+            distance[c*stride+count]=dist[c]==DBL_MAX?-1.0f:(float)dist[c];
+            nearest[c]=min(nearest[c],dist[c]);
+        }
+        next=farthest(grid,nearest);
+    }
+   }
+   //function to run dijkstra from cell start over the 8-connected grid,dist[c] is DBL_MAX if unreachable
+   template<class Grid>
+   void costsfrom(const Grid&grid,int start,vector<double>&dist){
+    dist.assign((size_t)ROW*COL,DBL_MAX);
+    typedef pair<double,int> entry;
+    priority_queue<entry,vector<entry>,greater<entry>> open;
+    dist[start]=0;
+    open.push(make_pair(0.0,start));
+    while(!open.empty()){
+        entry top=open.top();
+        open.pop();
+        int index=top.second;
+        if(top.first!=dist[index]) continue;
+        int i=index/COL;
+        int j=index%COL;
+        for(int d=0;d<8;d++){
+            int ni=i+DIRS[d].di;
+            int nj=j+DIRS[d].dj;
+            if(ni<0||ni>=ROW||nj<0||nj>=COL||!isfreecell(grid,ni,nj)) continue;
+            double g=top.first+(DIRS[d].di!=0&&DIRS[d].dj!=0?M_SQRT2:1.0)*cellcost(grid,ni,nj);
+            if(g<dist[ni*COL+nj]){
+                dist[ni*COL+nj]=g;
+                open.push(make_pair(g,ni*COL+nj));
+            }
+        }
+    }
+   }
+   //function to find the free cell with the largest cost in dist,cells no landmark reaches come first
+   //so every part of a disconnected grid gets a landmark,-1 if every free cell is a landmark already
+   template<class Grid>
+   int farthest(const Grid&grid,const vector<double>&dist){
+    int best=-1;
+    for(int c=0;c<ROW*COL;c++){
+        if(dist[c]>0&&isfreecell(grid,c/COL,c%COL)&&(best<0||dist[c]>dist[best])) best=c;
+    }
+    return best;
+   }
+   //function to get the landmark lower bound on the cost of going from cell from to cell to
+   double bound(int from,int to) const{
+    const float SLACK=1.0f/(1<<22);
+    //with symmetric costs x-y bounds the cost too,otherwise it is multiplied away
+    const float reverse=symmetric?1.0f:0.0f;
+    const float *a=&distance[(size_t)from*stride];
+    const float *b=&distance[(size_t)to*stride];
+    //LANES landmarks per step as one vector,the gcc vector extension keeps this SIMD without relying on the auto vectorizer
+    typedef float lanes __attribute__((vector_size(LANES*sizeof(float))));
+    const lanes zero={};
+    lanes best=zero;
+    for(int base=0;base<stride;base+=LANES){
+        lanes x,y;
+        memcpy(&x,a+base,sizeof(x));
+        memcpy(&y,b+base,sizeof(y));
+        lanes d=y-x;
+        lanes r=reverse*(x-y);
+        d=d>r?d:r;
+        d-=(x+y)*SLACK;
+        d=((x<zero)|(y<zero))?zero:d;
+        best=d>best?d:best;
+    }
+    float h=0;
+    for(int l=0;l<LANES;l++) h=max(h,best[l]);
+    return h;
+   }
+};
+//open list implementations that astareach can use
+enum OpenListKind{DARY_HEAP,RADIX_QUEUE};
+//plain A* expands all 8 neighbours,jump point search only the cells where a path may turn,
+//bidirectional A* grows one search from each end until they meet
+enum SearchMode{PLAIN_ASTAR,JUMP_POINT,BIDIRECTIONAL};
 class ASTARSEARCHALGORITHM{
 public:
    int ROW,COL;
-   ASTARSEARCHALGORITHM(int row,int col):ROW(row),COL(col){}
+   /*search workspace,one entry per cell stored row-major in a flat array
+   it is allocated once from ROW and COL and reused by every query
+   a cell's details are only meaningful if its visitstamp equals the current generation
+   and it is closed only if its closedstamp equals closedgeneration,so starting a new query
+   just bumps both and costs nothing for cells the query never touches
+   the anytime search bumps closedgeneration alone between its iterations,which reopens
+   every cell while keeping the g values found so far
+   */
+   vector<cell> celldetails;
+   vector<unsigned> visitstamp;
+   vector<unsigned> closedstamp;
+   unsigned generation;
+   unsigned closedgeneration;
+   //cells the anytime search improved after closing them in the current iteration
+   vector<unsigned> inconsstamp;
+   vector<int> incons;
+   //details and open list of the backward half of a bidirectional search,parents point towards dest
+   //allocated by the first bidirectional query and stamped with the same generation
+   vector<cell> reversedetails;
+   vector<unsigned> reversestamp;
+   IndexedDaryHeap<double> reverseopen;
+   //open list used by astareach and the two implementations it can switch between
+   OpenListKind openlistkind;
+   IndexedDaryHeap<double> heapopen;
+   RadixQueue radixopen;
+   SearchMode searchmode;
+   //number of cells taken off the open list by the last query
+   int expanded;
+   //landmark lower bounds raising the straight line heuristic,null when not used
+   const GRIDLANDMARKS *landmarks;
+   //packed row and column occupancy of the grid jump point search was prepared for
+   //shared so that every worker of a batch can use the same copy
+   shared_ptr<JumpBitmap> rowbits,colbits;
+   const void *bitmapsource;
+   ASTARSEARCHALGORITHM(int row,int col,OpenListKind kind=DARY_HEAP,SearchMode mode=PLAIN_ASTAR):ROW(row),COL(col),
+      celldetails((size_t)row*col),visitstamp((size_t)row*col,0),closedstamp((size_t)row*col,0),generation(0),closedgeneration(0),
+      openlistkind(kind),searchmode(mode),expanded(0),landmarks(nullptr),bitmapsource(nullptr){}
+
+   //function to convert coordinates of a cell into its index in the workspace
+   int cellindex(int row,int col){
+    return row*COL+col;
+   }
+   //function to start a new query on the workspace
+   void newsearch(){
+    generation++;
+    //stamps wrapped around so old stamps could look current,clear them once
+    if(generation==0){
+        fill(visitstamp.begin(),visitstamp.end(),0);
+        generation=1;
+    }
+    newiteration();
+   }
+   //function to reopen every cell of the current query
+   void newiteration(){
+    closedgeneration++;
+    if(closedgeneration==0){
+        fill(closedstamp.begin(),closedstamp.end(),0);
+        fill(inconsstamp.begin(),inconsstamp.end(),0);
+        closedgeneration=1;
+    }
+   }
+   //function to get details of a cell,resetting them the first time this query touches it
+   cell& touch(int index){
+    cell &c=celldetails[index];
+    if(visitstamp[index]!=generation){
+        visitstamp[index]=generation;
+        c.parent_i=-1;
+        c.parent_j=-1;
+        c.f=FLT_MAX;
+        c.g=FLT_MAX;
+        c.h=FLT_MAX;
+    }
+    return c;
+   }
+
+   //function to get the backward details of a cell,resetting them the first time this query touches it
+   cell& touchreverse(int index){
+    cell &c=reversedetails[index];
+    if(reversestamp[index]!=generation){
+        reversestamp[index]=generation;
+        c.parent_i=-1;
+        c.parent_j=-1;
+        c.f=FLT_MAX;
+        c.g=FLT_MAX;
+        c.h=FLT_MAX;
+    }
+    return c;
+   }
 
    //function to check that coordinates of cells are valid or not
    bool isvalid(int row,int col){
@@ -81,9 +732,10 @@ public:
     return false;
    }
    //function to check if a given cell is unblocked or not,1-unblocked(true returned),0-blocked(false returned)
-   bool isunblocked(int row,int col,const vector<vector<int>>&grid){
-    if(grid[row][col]==1) return true;
-    else return false;
+   //the grid is either a vector<vector<int>> or a memory mapped BITGRID
+   template<class Grid>
+   bool isunblocked(int row,int col,const Grid&grid){
+    return isfreecell(grid,row,col);
    }
    //functon to check if we have reached destination or not
    bool isdestination(int row,int col,Pair dest){
@@ -96,41 +748,543 @@ public:
         (row - dest.first) * (row - dest.first)
         + (col - dest.second) * (col - dest.second)));
    }
-   //function to trace path from source cell tpo destination cell
-   void tracepath(cell celldetails[][100],Pair dest){
-    cout<<"\nthe path is";
+   //function to calculate octile distance,the exact cost of an unobstructed 8-connected path
+   double calculateoctilevalue(int row,int col,Pair dest,double diagonal){
+    int di=abs(row-dest.first);
+    int dj=abs(col-dest.second);
+    return (double)(max(di,dj)-min(di,dj))+diagonal*min(di,dj);
+   }
+   //function to use landmark lower bounds built for the grid searched,or to stop using them with null
+   void uselandmarks(const GRIDLANDMARKS*table){
+    landmarks=table;
+   }
+   /*function to get the h value of a cell,the straight line estimate raised to the landmark bound
+   landmarks are only used with exact sqrt(2) diagonals,their float bounds are not whole
+   FIXEDSCALE units and could break the monotone keys the radix queue relies on
+   */
+   double estimate(int row,int col,Pair dest,bool fixedpoint,double diagonal){
+    if(fixedpoint) return calculateoctilevalue(row,col,dest,diagonal);
+    double h=calculatehvalue(row,col,dest);
+    if(landmarks) h=max(h,landmarks->bound(cellindex(row,col),cellindex(dest.first,dest.second)));
+    return h;
+   }
+   //function to get a lower bound on the cost from cell from to cell to,octile raised to the landmark bound
+   double lowerbound(int from,int to){
+    double h=calculateoctilevalue(from/COL,from%COL,make_pair(to/COL,to%COL),M_SQRT2);
+    if(landmarks) h=max(h,landmarks->bound(from,to));
+    return h;
+   }
+   //function to collect the cells of the path from source cell to destination cell,in order
+   void collectpath(Pair dest,vector<Pair>&path){
+    path.clear();
     //initialse variables to coordinates of destination cell
     int i=dest.first;
     int j=dest.second;
-    //use stack to store coordinates of cells 
-    stack<Pair> path;
     //a loop that runs till we reach source cell
     //parent coordinates of source cell are source coordinates itself
-    while(!(celldetails[i][j].parent_i==i&&celldetails[i][j].parent_j==j)){
-        path.push(make_pair(i,j));
-        int temp_i=celldetails[i][j].parent_i;
-        int temp_j=celldetails[i][j].parent_j;
+    while(!(celldetails[cellindex(i,j)].parent_i==i&&celldetails[cellindex(i,j)].parent_j==j)){
+        path.push_back(make_pair(i,j));
+        int temp_i=celldetails[cellindex(i,j)].parent_i;
+        int temp_j=celldetails[cellindex(i,j)].parent_j;
         i=temp_i;
         j=temp_j;
     }
-    //push coordinates of source cell into stack
-    path.push(make_pair(i,j));
-    //print all values of stack from top to bottom to generate the shortest part
-    while(!path.empty()){
-        pair<int,int> p=path.top();
-        path.pop();
-        cout<<"("<<p.first<<","<<p.second<<")";
-        if(!path.empty())cout<<"->";
-
-
+    //push coordinates of source cell and put the cells in source to destination order
+    path.push_back(make_pair(i,j));
+    reverse(path.begin(),path.end());
+   }
+   //function to trace path from source cell tpo destination cell
+   void tracepath(Pair dest){
+    vector<Pair> path;
+    collectpath(dest,path);
+    printpath(path);
+   }
+   /*function to run A* on the workspace with the given open list,true if dest is reached
+   a step costs its length times the cost of the cell it enters,1 on grids without costs
+   the open list decides the cost arithmetic:the d-ary heap uses exact sqrt(2) diagonals
+   with the euclidean heuristic,the radix queue rounds diagonals to FIXEDSCALE units and
+   uses the octile heuristic so every f value is an exact integer key
+   */
+   template<class Grid,class OpenList>
+   bool search(const Grid&grid,Pair src,Pair dest,OpenList&openlist){
+    //start a new generation of the workspace instead of clearing every cell
+    //closed list and cell details of the previous query become stale in O(1)
+    newsearch();
+    openlist.clear();
+    expanded=0;
+    const bool fixedpoint=OpenList::FIXEDPOINT;
+    const double diagonal=fixedpoint?RadixQueue::tokey(M_SQRT2)/(double)RadixQueue::FIXEDSCALE:M_SQRT2;
+    //initialise parameters of source node,its parent is itself
+    int target=cellindex(dest.first,dest.second);
+    int start=cellindex(src.first,src.second);
+    cell &source=touch(start);
+    source.parent_i=src.first;
+    source.parent_j=src.second;
+    source.g=0;
+    source.h=estimate(src.first,src.second,dest,fixedpoint,diagonal);
+    source.f=source.h;
+    openlist.push(start,source.f);
+    while(!openlist.empty()){
+        //cell with least f value is removed from the open list
+        int index=openlist.pop();
+        //destination is only final once it leaves the open list,so the path is optimal
+        if(index==target) return true;
+        //cell is under evalaution so mark it closed for this generation
+        closedstamp[index]=closedgeneration;
+        expanded++;
+        int i=index/COL;
+        int j=index%COL;
+        double g=celldetails[index].g;
+        //generate 8 successors of this cell
+        for(int d=0;d<8;d++){
+            int ni=i+DIRS[d].di;
+            int nj=j+DIRS[d].dj;
+            //only continue if cell is valid,unblocked and not on closed list
+            if(!isvalid(ni,nj)) continue;
+            int nidx=cellindex(ni,nj);
+            if(closedstamp[nidx]==closedgeneration||!isunblocked(ni,nj,grid)) continue;
+            double gnew=g+(DIRS[d].di!=0&&DIRS[d].dj!=0?diagonal:1.0)*cellcost(grid,ni,nj);
+            cell &succ=touch(nidx);
+            //if successor isnt on open list or this is a better path to it
+            //update its details and insert it or lower its key in place
+            if(gnew<succ.g){
+                if(succ.h==FLT_MAX){
+                    succ.h=estimate(ni,nj,dest,fixedpoint,diagonal);
+                }
+                succ.g=gnew;
+                succ.f=gnew+succ.h;
+                succ.parent_i=i;
+                succ.parent_j=j;
+                openlist.push(nidx,succ.f);
+            }
+        }
+    }
+    return false;
+   }
+   //function to (re)pack the grid for jump point search,call it again after editing the grid
+   template<class Grid>
+   void preparejumpsearch(const Grid&grid){
+    rowbits=make_shared<JumpBitmap>();
+    colbits=make_shared<JumpBitmap>();
+    rowbits->build(grid,ROW,COL,false);
+    colbits->build(grid,ROW,COL,true);
+    bitmapsource=&grid;
+   }
+   //function to reuse the bitmaps another search over the same grid already prepared
+   void sharejumpsearch(const ASTARSEARCHALGORITHM&other){
+    rowbits=other.rowbits;
+    colbits=other.colbits;
+    bitmapsource=other.bitmapsource;
+   }
+   //function to jump straight from (i,j) in direction (di,dj),returns the jump point or -1
+   int jumpstraight(int i,int j,int di,int dj,Pair dest){
+    if(di==0){
+        int c=rowbits->scan(i,j+dj,dj,dest.first==i?dest.second:INT_MIN);
+        return c<0?-1:cellindex(i,c);
+    }
+    int r=colbits->scan(j,i+di,di,dest.second==j?dest.first:INT_MIN);
+    return r<0?-1:cellindex(r,j);
+   }
+   /*function to jump diagonally from (i,j) in direction (di,dj),returns the jump point or -1
+   a cell is a jump point if it is the goal,has a forced neighbour,or a straight jump
+   along either component of the direction finds one
+   */
+   int jumpdiagonal(int i,int j,int di,int dj,Pair dest){
+    while(true){
+        i+=di;
+        j+=dj;
+        if(rowbits->blocked(i,j)) return -1;
+        if(isdestination(i,j,dest)) return cellindex(i,j);
+        if((rowbits->blocked(i-di,j)&&!rowbits->blocked(i-di,j+dj))
+            ||(rowbits->blocked(i,j-dj)&&!rowbits->blocked(i+di,j-dj))) return cellindex(i,j);
+        if(jumpstraight(i,j,0,dj,dest)>=0||jumpstraight(i,j,di,0,dest)>=0) return cellindex(i,j);
     }
-    cout<<endl;
-    return;
-
-    
+   }
+   /*function to run jump point search,returns the same optimal cost as search() but only
+   cells where the optimal path may turn are put on the open list,the moves in between are
+   filled back into the parent links afterwards so tracepath sees a cell by cell path
+   */
+   template<class Grid,class OpenList>
+   bool jumpsearch(const Grid&grid,Pair src,Pair dest,OpenList&openlist){
+    if(bitmapsource!=&grid) preparejumpsearch(grid);
+    newsearch();
+    openlist.clear();
+    expanded=0;
+    const bool fixedpoint=OpenList::FIXEDPOINT;
+    const double diagonal=fixedpoint?RadixQueue::tokey(M_SQRT2)/(double)RadixQueue::FIXEDSCALE:M_SQRT2;
+    int target=cellindex(dest.first,dest.second);
+    int start=cellindex(src.first,src.second);
+    cell &source=touch(start);
+    source.parent_i=src.first;
+    source.parent_j=src.second;
+    source.g=0;
+    source.h=estimate(src.first,src.second,dest,fixedpoint,diagonal);
+    source.f=source.h;
+    openlist.push(start,source.f);
+    while(!openlist.empty()){
+        int index=openlist.pop();
+        if(index==target){
+            fillpath(dest);
+            return true;
+        }
+        closedstamp[index]=closedgeneration;
+        expanded++;
+        int i=index/COL;
+        int j=index%COL;
+        double g=celldetails[index].g;
+        //directions worth following,pruned by the direction we arrived from
+        int dirs[8][2];
+        int ndirs=0;
+        int pi=celldetails[index].parent_i;
+        int pj=celldetails[index].parent_j;
+        if(index==start){
+            for(int d=0;d<8;d++){
+                dirs[ndirs][0]=DIRS[d].di;
+                dirs[ndirs][1]=DIRS[d].dj;
+                ndirs++;
+            }
+        }
+        else{
+            int di=(i>pi)-(i<pi);
+            int dj=(j>pj)-(j<pj);
+            auto add=[&](int a,int b){dirs[ndirs][0]=a;dirs[ndirs][1]=b;ndirs++;};
+            if(di==0){
+                add(0,dj);
+                if(rowbits->blocked(i-1,j)) add(-1,dj);
+                if(rowbits->blocked(i+1,j)) add(1,dj);
+            }
+            else if(dj==0){
+                add(di,0);
+                if(rowbits->blocked(i,j-1)) add(di,-1);
+                if(rowbits->blocked(i,j+1)) add(di,1);
+            }
+            else{
+                add(di,0);
+                add(0,dj);
+                add(di,dj);
+                if(rowbits->blocked(i-di,j)) add(-di,dj);
+                if(rowbits->blocked(i,j-dj)) add(di,-dj);
+            }
+        }
+        for(int d=0;d<ndirs;d++){
+            int di=dirs[d][0];
+            int dj=dirs[d][1];
+            int jump=(di!=0&&dj!=0)?jumpdiagonal(i,j,di,dj,dest):jumpstraight(i,j,di,dj,dest);
+            if(jump<0||closedstamp[jump]==closedgeneration) continue;
+            int ni=jump/COL;
+            int nj=jump%COL;
+            int steps=max(abs(ni-i),abs(nj-j));
+            double gnew=g+steps*((di!=0&&dj!=0)?diagonal:1.0);
+            cell &succ=touch(jump);
+            if(gnew<succ.g){
+                if(succ.h==FLT_MAX){
+                    succ.h=estimate(ni,nj,dest,fixedpoint,diagonal);
+                }
+                succ.g=gnew;
+                succ.f=gnew+succ.h;
+                succ.parent_i=i;
+                succ.parent_j=j;
+                openlist.push(jump,succ.f);
+            }
+        }
+    }
+    return false;
+   }
+   //function to link every cell between consecutive jump points back to the previous cell
+   void fillpath(Pair dest){
+    int i=dest.first;
+    int j=dest.second;
+    while(!(celldetails[cellindex(i,j)].parent_i==i&&celldetails[cellindex(i,j)].parent_j==j)){
+        int pi=celldetails[cellindex(i,j)].parent_i;
+        int pj=celldetails[cellindex(i,j)].parent_j;
+        int di=(pi>i)-(pi<i);
+        int dj=(pj>j)-(pj<j);
+        for(int ci=i,cj=j;ci!=pi||cj!=pj;ci+=di,cj+=dj){
+            cell &c=touch(cellindex(ci,cj));
+            c.parent_i=ci+di;
+            c.parent_j=cj+dj;
+        }
+        i=pi;
+        j=pj;
+    }
+   }
+   /*function to run bidirectional A* (NBA*),true if dest is reached
+   a forward search from src and a backward search from dest take turns,the one with the
+   smaller open list expands next,and every cell is expanded by at most one of them
+   best is the cheapest src-dest path seen through a cell both searches reached,a popped cell
+   is dropped without expanding when either its own f or its g plus the lowest f of the other
+   side minus its heuristic towards the other end shows no path through it can beat best
+   the search ends when either open list runs empty,best is then optimal for a consistent heuristic
+   the backward half is spliced onto the parent links afterwards so tracepath sees one path
+   both halves use the d-ary heap with the octile heuristic (raised by landmarks if any)
+   whatever open list is configured
+   */
+   template<class Grid>
+   bool bidirectionalsearch(const Grid&grid,Pair src,Pair dest){
+    if(heapopen.capacity()!=ROW*COL) heapopen.resize(ROW*COL);
+    if(reverseopen.capacity()!=ROW*COL){
+        reverseopen.resize(ROW*COL);
+        reversedetails.resize((size_t)ROW*COL);
+        reversestamp.assign((size_t)ROW*COL,0);
+    }
+    newsearch();
+    heapopen.clear();
+    reverseopen.clear();
+    expanded=0;
+    int start=cellindex(src.first,src.second);
+    int target=cellindex(dest.first,dest.second);
+    cell &source=touch(start);
+    source.parent_i=src.first;
+    source.parent_j=src.second;
+    source.g=0;
+    source.h=lowerbound(start,target);
+    source.f=source.h;
+    heapopen.push(start,source.f);
+    cell &sink=touchreverse(target);
+    sink.parent_i=dest.first;
+    sink.parent_j=dest.second;
+    sink.g=0;
+    sink.h=lowerbound(start,target);
+    sink.f=sink.h;
+    reverseopen.push(target,sink.f);
+    //lowest f on each open list as of the last pop from it
+    double forwardtop=source.f,backwardtop=sink.f;
+    double best=FLT_MAX;
+    int meet=-1;
+    while(!heapopen.empty()&&!reverseopen.empty()){
+        bool forward=heapopen.size()<=reverseopen.size();
+        IndexedDaryHeap<double> &open=forward?heapopen:reverseopen;
+        int index=open.pop();
+        //a cell the other side already expanded is not expanded again
+        if(closedstamp[index]!=closedgeneration){
+            closedstamp[index]=closedgeneration;
+            int i=index/COL;
+            int j=index%COL;
+            const cell &x=forward?celldetails[index]:reversedetails[index];
+            double g=x.g;
+            double hother=forward?lowerbound(start,index):lowerbound(index,target);
+            if(x.f<best&&g+(forward?backwardtop:forwardtop)-hother<best){
+                expanded++;
+                for(int d=0;d<8;d++){
+                    int ni=i+DIRS[d].di;
+                    int nj=j+DIRS[d].dj;
+                    if(!isvalid(ni,nj)) continue;
+                    int nidx=cellindex(ni,nj);
+                    if(closedstamp[nidx]==closedgeneration||!isunblocked(ni,nj,grid)) continue;
+                    //a step costs the cell it enters,which going backwards is the cell we stand on
+                    double gnew=g+(DIRS[d].di!=0&&DIRS[d].dj!=0?M_SQRT2:1.0)*(forward?cellcost(grid,ni,nj):cellcost(grid,i,j));
+                    cell &succ=forward?touch(nidx):touchreverse(nidx);
+                    if(gnew<succ.g){
+                        if(succ.h==FLT_MAX) succ.h=forward?lowerbound(nidx,target):lowerbound(start,nidx);
+                        succ.g=gnew;
+                        succ.f=gnew+succ.h;
+                        succ.parent_i=i;
+                        succ.parent_j=j;
+                        open.push(nidx,succ.f);
+                        //both searches have now reached this cell,so there is a path through it
+                        bool reached=forward?reversestamp[nidx]==generation:visitstamp[nidx]==generation;
+                        if(reached){
+                            double other=forward?reversedetails[nidx].g:celldetails[nidx].g;
+                            if(gnew+other<best){
+                                best=gnew+other;
+                                meet=nidx;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        if(!open.empty()) (forward?forwardtop:backwardtop)=open.topkey();
+    }
+    if(meet<0) return false;
+    //relink the backward half,from the meeting cell to dest,as forward parent links
+    int i=meet/COL;
+    int j=meet%COL;
+    while(!(i==dest.first&&j==dest.second)){
+        const cell &back=reversedetails[cellindex(i,j)];
+        cell &next=touch(cellindex(back.parent_i,back.parent_j));
+        next.parent_i=i;
+        next.parent_j=j;
+        i=back.parent_i;
+        j=back.parent_j;
+    }
+    touch(target).g=best;
+    return true;
+   }
+   //function to run the configured search mode with the configured open list
+   //jump point search is only optimal when every step of a length costs the same,so grids with
+   //per cell costs always get plain A*
+   template<class Grid>
+   bool runsearch(const Grid&grid,Pair src,Pair dest){
+    if(searchmode==BIDIRECTIONAL) return bidirectionalsearch(grid,src,dest);
+    bool jump=searchmode==JUMP_POINT&&!hascellcosts(grid);
+    //open lists are sized once for the whole grid,like the rest of the workspace
+    if(openlistkind==RADIX_QUEUE){
+        if(radixopen.capacity()!=ROW*COL) radixopen.resize(ROW*COL);
+        return jump?jumpsearch(grid,src,dest,radixopen):search(grid,src,dest,radixopen);
+    }
+    if(heapopen.capacity()!=ROW*COL) heapopen.resize(ROW*COL);
+    return jump?jumpsearch(grid,src,dest,heapopen):search(grid,src,dest,heapopen);
+   }
+   /*function to find a path without printing anything,for callers that answer many queries
+   appends the flat indices of the path cells from source to destination to cells
+   and returns false (appending nothing) if there is no path or the query is invalid
+   */
+   template<class Grid>
+   bool findpath(const Grid&grid,Pair src,Pair dest,vector<int>&cells,double&cost){
+    if(!isvalid(src.first,src.second)||!isvalid(dest.first,dest.second)) return false;
+    if(!isunblocked(src.first,src.second,grid)||!isunblocked(dest.first,dest.second,grid)) return false;
+    if(isdestination(src.first,src.second,dest)){
+        cells.push_back(cellindex(src.first,src.second));
+        cost=0;
+        return true;
+    }
+    if(!runsearch(grid,src,dest)) return false;
+    cost=celldetails[cellindex(dest.first,dest.second)].g;
+    appendpath(dest,cells);
+    return true;
+   }
+   //function to append the flat indices of the path ending at dest,from its source onwards
+   void appendpath(Pair dest,vector<int>&cells){
+    size_t mark=cells.size();
+    int i=dest.first;
+    int j=dest.second;
+    while(true){
+        cells.push_back(cellindex(i,j));
+        const cell &c=celldetails[cellindex(i,j)];
+        if(c.parent_i==i&&c.parent_j==j) break;
+        i=c.parent_i;
+        j=c.parent_j;
+    }
+    reverse(cells.begin()+mark,cells.end());
+   }
+   /*function to find a path with anytime repairing A* (ARA*) within a time budget
+   the first iteration runs A* with the heuristic inflated by weight,which returns a path costing
+   at most weight times the optimum after expanding far fewer cells,then every further iteration
+   lowers the inflation and carries on from the g values and open list the last one left,
+   re-expanding only the cells whose g went down,until the inflation reaches 1 or the budget
+   (in milliseconds) is spent
+   the first path is always completed even if that takes longer than the budget
+   cells gets the best path found,cost its cost and bound a factor it is proven to be within
+   of the optimal cost,improved (if given) is called with every better path as soon as it is found
+   the inflated keys are not monotone so this always uses the d-ary heap
+   */
+   template<class Grid>
+   bool anytimepath(const Grid&grid,Pair src,Pair dest,double weight,double budget,vector<int>&cells,double&cost,double&bound,
+      const function<void(const vector<int>&,double,double)>&improved=nullptr){
+    if(!isvalid(src.first,src.second)||!isvalid(dest.first,dest.second)) return false;
+    if(!isunblocked(src.first,src.second,grid)||!isunblocked(dest.first,dest.second,grid)) return false;
+    if(isdestination(src.first,src.second,dest)){
+        cells.push_back(cellindex(src.first,src.second));
+        cost=0;
+        bound=1;
+        if(improved) improved(vector<int>(1,cells.back()),cost,bound);
+        return true;
+    }
+    auto deadline=chrono::steady_clock::now()+chrono::duration<double,milli>(budget);
+    if(heapopen.capacity()!=ROW*COL) heapopen.resize(ROW*COL);
+    if(inconsstamp.size()!=(size_t)ROW*COL) inconsstamp.assign((size_t)ROW*COL,0);
+    newsearch();
+    heapopen.clear();
+    incons.clear();
+    expanded=0;
+    double epsilon=max(1.0,weight);
+    int target=cellindex(dest.first,dest.second);
+    int start=cellindex(src.first,src.second);
+    cell &source=touch(start);
+    source.parent_i=src.first;
+    source.parent_j=src.second;
+    source.g=0;
+    source.h=lowerbound(start,target);
+    source.f=epsilon*source.h;
+    heapopen.push(start,source.f);
+    //g value of the goal when the last path was reported
+    double reported=FLT_MAX;
+    vector<int> path;
+    bool expired=false;
+    while(true){
+        //improve the path:expand while some open cell could still lead to a cheaper goal
+        while(!heapopen.empty()&&touch(target).g>heapopen.topkey()){
+            //the clock is read every 256 expansions,and only once there is a path to fall back on
+            if((expanded&255)==0&&touch(target).g<FLT_MAX&&chrono::steady_clock::now()>=deadline){
+                expired=true;
+                break;
+            }
+            int index=heapopen.pop();
+            closedstamp[index]=closedgeneration;
+            expanded++;
+            int i=index/COL;
+            int j=index%COL;
+            double g=celldetails[index].g;
+            for(int d=0;d<8;d++){
+                int ni=i+DIRS[d].di;
+                int nj=j+DIRS[d].dj;
+                if(!isvalid(ni,nj)||!isunblocked(ni,nj,grid)) continue;
+                int nidx=cellindex(ni,nj);
+                double gnew=g+(DIRS[d].di!=0&&DIRS[d].dj!=0?M_SQRT2:1.0)*cellcost(grid,ni,nj);
+                cell &succ=touch(nidx);
+                if(gnew<succ.g){
+                    if(succ.h==FLT_MAX) succ.h=lowerbound(nidx,target);
+                    succ.g=gnew;
+                    succ.f=gnew+epsilon*succ.h;
+                    succ.parent_i=i;
+                    succ.parent_j=j;
+                    //a cell closed in this iteration waits for the next one instead of reopening now
+                    if(closedstamp[nidx]!=closedgeneration) heapopen.push(nidx,succ.f);
+                    else if(inconsstamp[nidx]!=closedgeneration){
+                        inconsstamp[nidx]=closedgeneration;
+                        incons.push_back(nidx);
+                    }
+                }
+            }
+        }
+        double goalg=touch(target).g;
+        if(goalg==FLT_MAX) return false;
+        bool better=goalg<reported;
+        if(better){
+            reported=goalg;
+            path.clear();
+            appendpath(dest,path);
+            //following the parents can only be cheaper than g of the goal,so cost the path itself
+            cost=0;
+            for(size_t k=1;k<path.size();k++){
+                int i=path[k]/COL;
+                int j=path[k]%COL;
+                bool diagonal=i!=path[k-1]/COL&&j!=path[k-1]%COL;
+                cost+=(diagonal?M_SQRT2:1.0)*cellcost(grid,i,j);
+            }
+        }
+        //every cheaper path must pass through an open or inconsistent cell,so the smallest
+        //uninflated f among them is a lower bound on the optimal cost
+        double lower=goalg;
+        for(int index:incons) lower=min(lower,celldetails[index].g+celldetails[index].h);
+        heapopen.foreach([&](int index){
+            lower=min(lower,celldetails[index].g+celldetails[index].h);
+        });
+        bound=max(1.0,cost/lower);
+        //only a finished iteration proves the goal is within epsilon
+        if(!expired) bound=min(bound,epsilon);
+        if(better&&improved) improved(path,cost,bound);
+        if(expired||bound<=1.0||epsilon==1.0||chrono::steady_clock::now()>=deadline) break;
+        //halve the inflation,but never keep it above what the bound already proves
+        epsilon=min(bound,1.0+(epsilon-1.0)/2);
+        if(epsilon<1.02) epsilon=1.0;
+        //next iteration:inconsistent cells rejoin the open list and every key is recomputed
+        newiteration();
+        for(int index:incons) heapopen.push(index,0);
+        incons.clear();
+        heapopen.rekey([&](int index){
+            cell &c=celldetails[index];
+            c.f=c.g+epsilon*c.h;
+            return c.f;
+        });
+    }
+    cells.insert(cells.end(),path.begin(),path.end());
+    return true;
    }
    //function to implemet astarsearch to find shortest path
-   void astareach(const vector<vector<int>>&grid,Pair src,Pair dest){
+   template<class Grid>
+   void astareach(const Grid&grid,Pair src,Pair dest){
     //to check if source and destination coordinates are valid or not
     if(!isvalid(src.first,src.second)){
         cout<<"source is invalid"<<endl;
@@ -155,319 +1309,869 @@ public:
         return;
 
     }
-    //create a closed list to keep track which cells have been evalauted
-    //list is intialised to false meaning no cell has been evalauted
-    //it is of bool type
-
-    //closed list hepls to avoid cells that have been already evaluated 
-    //improves effficiency
-    vector<vector<bool>> closedlist(ROW,vector<bool>(COL,false));
-    //declaring a 2d array of class cell to hold details of every cell
-    cell celldetails[100][100];
-    int i,j;
-    for(i=0;i<ROW;i++){
-        for(j=0;j<COL;j++){
-            celldetails[i][j].parent_i=-1;
-            celldetails[i][j].parent_j=-1;
-            celldetails[i][j].f=FLT_MAX;
-            celldetails[i][j].g=FLT_MAX;
-            celldetails[i][j].h=FLT_MAX;
-
-        }
+    bool found_dest=runsearch(grid,src,dest);
+    if(found_dest==false){
+        cout<<"failed to find destination cell"<<endl;
+        return;
     }
-    //initialise parameters of source node
-    i=src.first;
-    j=src.second;
-    celldetails[i][j].parent_i=i;
-    celldetails[i][j].parent_j=j;
-    celldetails[i][j].f=0;
-    celldetails[i][j].g=0;
-    celldetails[i][j].h=0;
-    /*creating an open list that contains cells for evaluation
-    contains cells that are candidates for evaluation 
-    cell with least f value will be selected 
-    each cell has maximum 8 neighbours that can be evaluated 
-    */
-   //priority queue is used to implement openlist i.e. min-heap as it hepls to find element in logn time
-   PriorityQueue openlist;
-    
-    
-    //put the source cell on open list and initialise its f as zero
-    openlist.push({0,{i,j}});
-    //variable is defined to check if final destination is reached or not
-    bool found_dest=false;
-    while(!openlist.empty()){
-        auto p=openlist.top();
-        //removing this coordinate
-        openlist.pop();
-        i=p.second.first;
-        j=p.second.second;
-        //cell is under evalaution so change its bool value in closed list
-        closedlist[i][j]=true;
-        
-        //generate 8 successors of this cell
-        /*
-        N-(i,j+1)
-        S-(i,j-1)
-        W-(i-1,j)
-        E-(i+1,j)
-        NW-(i-1,j+1)
-        NE-(i+1,j+1)
-        SW-(i-1,j-1)
-        SE-(i+1,j-1)
-        */
-       //declare f,g,h cost value of successor cells
-       double hnew,gnew,fnew;
-       //1st Successor-(i,j+1)
-       //only continue if cell is valid one
-       if(isvalid(i,j+1)){
-        //if successor is same as destination
-        if(isdestination(i,j+1,dest)){
-            //set successors parents coordinates to i and j
-            celldetails[i][j+1].parent_i=i;
-            celldetails[i][j+1].parent_j=j;
-            cout<<"destination cell is found"<<endl;
-            tracepath(celldetails,dest);
-            found_dest=true;
-            return;
-        }
-        //if successor is not on closed list
-        //and it is unblocked 
-        else if(closedlist[i][j+1]==false&&isunblocked(i,j+1,grid)){
-            gnew=celldetails[i][j].g+1;
-            hnew=calculatehvalue(i,j+1,dest);
-            fnew=gnew+hnew;
-            //if successor isnt on open list
-            //add it to open list
-            //set cell as its parents and update cost values
-            //if successor is in open list
-            //check if it is better path to destination
-            //compare f value and fnew
-            if(celldetails[i][j+1].f==FLT_MAX||celldetails[i][j+1].f>fnew){
-                //inserting to open list
-                openlist.push(make_pair(fnew,make_pair(i,j+1)));
-                 //update its details
-                celldetails[i][j+1].g=gnew;
-                celldetails[i][j+1].h=hnew;
-                celldetails[i][j+1].f=fnew;
-                celldetails[i][j+1].parent_i=i;
-                celldetails[i][j+1].parent_j=j;
+    cout<<"destination cell is found"<<endl;
+    tracepath(dest);
 
-            }
-        }
-       }
-       //repeat for remaining 7 successors
-       //2nd successor-(i,j-1)
-       //check for valid
-       if(isvalid(i,j-1)){
-        //if same as destination cell or not
-        if(isdestination(i,j-1,dest)){
-            celldetails[i][j-1].parent_i=i;
-            celldetails[i][j-1].parent_j=j;
-            cout<<"destination cell is found"<<endl;
-            tracepath(celldetails,dest);
-            found_dest=true;
-            return;
-        }
-        //if unblocked and not on closedlist
-        else if(closedlist[i][j-1]==false&&isunblocked(i,j-1,grid)){
-            gnew=celldetails[i][j].g+1;
-            hnew=calculatehvalue(i,j-1,dest);
-            fnew=gnew+hnew;
-            //if not on openlist or fnew<f
-            if(celldetails[i][j-1].f==FLT_MAX||celldetails[i][j-1].f>fnew){
-                openlist.insert(make_pair(fnew,make_pair(i,j-1)));
-                celldetails[i][j-1].g=gnew;
-                celldetails[i][j-1].h=hnew;
-                celldetails[i][j-1].f=fnew;
-                celldetails[i][j-1].parent_i=i;
-                celldetails[i][j-1].parent_j=j;
+   }
 
-            }
+   template<class Grid>
+   void implement_a_star_search(const Grid&grid,Pair src,Pair dest){
+    astareach(grid,src,dest);
+    return;
+   }
 
-        }
-       }
-       //3rd successor-(i-1,j)
-       if(isvalid(i-1,j)){
-        if(isdestination(i-1,j,dest)){
-            celldetails[i-1][j].parent_i=i;
-            celldetails[i-1][j].parent_j=j;
-            cout<<"destination is found"<<endl;
-            tracepath(celldetails,dest);
-            found_dest=true;
-            return;
 
 
-        }
-        else if(closedlist[i-1][j]==false&&isunblocked(i-1,j,grid)){
-            gnew=celldetails[i][j].g+1;
-            hnew=calculatehvalue(i-1,j,dest);
-            fnew=gnew+hnew;
-            if(celldetails[i-1][j].f==FLT_MAX||celldetails[i-1][j].f>fnew){
-                openlist.push(make_pair(fnew,make_pair(i-1,j)));
-                celldetails[i-1][j].g=gnew;
-                celldetails[i-1][j].h=hnew;
-                celldetails[i-1][j].f=fnew;
-                celldetails[i-1][j].parent_i=i;
-                celldetails[i-1][j].parent_j=j;
-  
-            }
+   
+   
 
-        }
-       
-       }
-       //4th successor-(i+1,j)
-       if(isvalid(i+1,j)){
-        if(isdestination(i+1,j,dest)){
-            celldetails[i+1][j].parent_i=i;
-            celldetails[i+1][j].parent_j=j;
-            cout<<"destination is found"<<endl;
-            tracepath(celldetails,dest);
-            found_dest=true;
-            return;
-        }
-        else if(closedlist[i+1][j]==false&&isunblocked(i+1,j,grid)){
-            gnew=celldetails[i][j].g+1;
-            hnew=calculatehvalue(i+1,j,dest);
-            fnew=gnew+hnew;
-            if(celldetails[i+1][j].f==FLT_MAX||celldetails[i+1][j].f>fnew){
-                openlist.push(make_pair(fnew,make_pair(i+1,j)));
-                celldetails[i+1][j].g=gnew;
-                celldetails[i+1][j].h=hnew;
-                celldetails[i+1][j].f=fnew;
-                celldetails[i+1][j].parent_i=i;
-                celldetails[i+1][j].parent_j=j;
+};
+/*hierarchical pathfinding (HPA*) on top of the cell grid
+the grid is cut into square clusters,wherever two clusters touch every run of free cell pairs
+across the border becomes one or two entrances,and the distances between the entrances of a
+cluster are found once by searches that never leave that cluster
+a query runs A* on this small abstract graph and is only turned into cells by refinepath
+editing a cell through setcell rebuilds the borders it lies on and the clusters next to them only
+*/
+class HIERARCHICALASTAR{
+public:
+   //runs of free border cells at least this long get an entrance at both ends instead of the middle
+   static const int LONG_ENTRANCE=6;
+   vector<vector<int>> &grid;
+   int ROW,COL,CLUSTER;
+   int clusterrows,clustercols;
+   //entrance pairs (upper or left cell,lower or right cell) as flat cell indices
+   //hborders[k] is the border below cluster k,vborders[k] the border right of it and
+   //corners[k] holds the diagonal crossings at its bottom right corner
+   vector<vector<pair<int,int>>> hborders,vborders,corners;
+   //cells across a border from every entrance cell
+   unordered_map<int,vector<int>> inter;
+   //edges between the entrances of every cluster,keyed by flat cell index
+   vector<unordered_map<int,vector<pair<int,double>>>> intra;
+   //number of clusters whose intra edges were computed by the last build or setcell
+   int rebuilt;
+   //cluster sized workspace for the searches that stay inside one cluster
+   vector<double> localg;
+   vector<int> localparent;
+   IndexedDaryHeap<double> localopen;
+   //workspace of the abstract search
+   unordered_map<int,double> abstractg;
+   unordered_map<int,int> abstractparent;
+   unordered_set<int> abstractclosed;
+   IndexedDaryHeap<double> abstractopen;
+   HIERARCHICALASTAR(vector<vector<int>>&grid,int row,int col,int cluster):grid(grid),ROW(row),COL(col),CLUSTER(cluster),
+      clusterrows((row+cluster-1)/cluster),clustercols((col+cluster-1)/cluster),rebuilt(0),
+      localg(cluster*cluster),localparent(cluster*cluster),localopen(cluster*cluster),abstractopen(row*col){
+    build();
+   }
 
+   int cellindex(int row,int col){
+    return row*COL+col;
+   }
+   int clusterof(int index){
+    return (index/COL/CLUSTER)*clustercols+(index%COL)/CLUSTER;
+   }
+   bool isfree(int index){
+    return grid[index/COL][index%COL]==1;
+   }
+   //function to get the cells covered by cluster k,rows r0..r1-1 and columns c0..c1-1
+   void clusterbounds(int k,int&r0,int&c0,int&r1,int&c1){
+    r0=(k/clustercols)*CLUSTER;
+    c0=(k%clustercols)*CLUSTER;
+    r1=min(r0+CLUSTER,ROW);
+    c1=min(c0+CLUSTER,COL);
+   }
+   double heuristic(int a,int b){
+    int di=abs(a/COL-b/COL);
+    int dj=abs(a%COL-b%COL);
+    return (double)(max(di,dj)-min(di,dj))+M_SQRT2*min(di,dj);
+   }
+   /*function to search from cell start without leaving cluster k
+   with goal -1 it settles the whole cluster,otherwise it stops once goal is reached
+   distances and parents are left in localg and localparent by local index
+   */
+   double localsearch(int k,int start,int goal){
+    int r0,c0,r1,c1;
+    clusterbounds(k,r0,c0,r1,c1);
+    fill(localg.begin(),localg.end(),DBL_MAX);
+    localopen.clear();
+    int s=(start/COL-r0)*CLUSTER+(start%COL-c0);
+    int t=goal<0?-1:(goal/COL-r0)*CLUSTER+(goal%COL-c0);
+    localg[s]=0;
+    localparent[s]=-1;
+    localopen.push(s,goal<0?0:heuristic(start,goal));
+    while(!localopen.empty()){
+        int l=localopen.pop();
+        if(l==t) return localg[l];
+        int i=r0+l/CLUSTER;
+        int j=c0+l%CLUSTER;
+        for(int d=0;d<8;d++){
+            int ni=i+DIRS[d].di;
+            int nj=j+DIRS[d].dj;
+            if(ni<r0||ni>=r1||nj<c0||nj>=c1||grid[ni][nj]!=1) continue;
+            int nl=(ni-r0)*CLUSTER+(nj-c0);
+            double gnew=localg[l]+DIRS[d].cost;
+            if(gnew<localg[nl]){
+                localg[nl]=gnew;
+                localparent[nl]=l;
+                localopen.push(nl,gnew+(goal<0?0:heuristic(cellindex(ni,nj),goal)));
             }
         }
-       
-       }
-       //5th successor-(i-1,j-1)
-       if(isvalid(i-1,j-1)){
-        if(isdestination(i-1,j-1,dest)){
-            celldetails[i-1][j-1].parent_i=i;
-            celldetails[i-1][j-1].parent_j=j;
-            cout<<"destination is found"<<endl;
-            tracepath(celldetails,dest);
-            found_dest=true;
-            return;
-        }
-        else if(closedlist[i-1][j-1]==false&&isunblocked(i-1,j-1,grid)){
-            gnew=celldetails[i][j].g+sqrt(2);
-            hnew=calculatehvalue(i-1,j-1,dest);
-            fnew=gnew+hnew;
-            if(celldetails[i-1][j-1].f==FLT_MAX||celldetails[i-1][j-1].f>fnew){
-                openlist.push(make_pair(fnew,make_pair(i-1,j-1)));
-                celldetails[i-1][j-1].g=gnew;
-                celldetails[i-1][j-1].h=hnew;
-                celldetails[i-1][j-1].f=fnew;
-                celldetails[i-1][j-1].parent_i=i;
-                celldetails[i-1][j-1].parent_j=j;
+    }
+    return goal<0?0:DBL_MAX;
+   }
+   //function to read the distance the last localsearch in cluster k found to a cell
+   double localdistance(int k,int index){
+    int r0,c0,r1,c1;
+    clusterbounds(k,r0,c0,r1,c1);
+    return localg[(index/COL-r0)*CLUSTER+(index%COL-c0)];
+   }
+   void link(pair<int,int> e){
+    inter[e.first].push_back(e.second);
+    inter[e.second].push_back(e.first);
+   }
+   void unlink(pair<int,int> e){
+    for(int side=0;side<2;side++){
+        int a=side?e.second:e.first;
+        int b=side?e.first:e.second;
+        vector<int> &across=inter[a];
+        across.erase(find(across.begin(),across.end(),b));
+        if(across.empty()) inter.erase(a);
+    }
+   }
+   /*function to recompute the entrances on the border below(or right of) cluster k
+   returns true if they changed,so the clusters on both sides need new intra edges
+   */
+   bool buildborder(int k,bool below){
+    int r0,c0,r1,c1;
+    clusterbounds(k,r0,c0,r1,c1);
+    vector<pair<int,int>> &border=below?hborders[k]:vborders[k];
+    vector<pair<int,int>> old;
+    old.swap(border);
+    int length=below?c1-c0:r1-r0;
+    //cell pair number t across the border
+    auto across=[&](int t){
+        int a=below?cellindex(r1-1,c0+t):cellindex(r0+t,c1-1);
+        return make_pair(a,below?a+COL:a+1);
+    };
+    auto open=[&](int t){
+        pair<int,int> e=across(t);
+        return isfree(e.first)&&isfree(e.second);
+    };
+    int t=0;
+    while(t<length){
+        if(!open(t)){
+            t++;
+            continue;
+        }
+        int first=t;
+        while(t<length&&open(t)) t++;
+        if(t-first<LONG_ENTRANCE){
+            border.push_back(across(first+(t-first)/2));
+        }
+        else{
+            border.push_back(across(first));
+            border.push_back(across(t-1));
+        }
+    }
+    //diagonal moves may cut corners,so two cells can be joined across the border only by a
+    //diagonal step when neither of them is part of a run,those crossings become entrances too
+    for(t=0;t+1<length;t++){
+        pair<int,int> x=across(t);
+        pair<int,int> y=across(t+1);
+        if(isfree(x.first)&&!isfree(x.second)&&isfree(y.second)&&!isfree(y.first)) border.push_back({x.first,y.second});
+        if(!isfree(x.first)&&isfree(x.second)&&isfree(y.first)&&!isfree(y.second)) border.push_back({y.first,x.second});
+    }
+    if(border==old) return false;
+    for(auto &e:old) unlink(e);
+    for(auto &e:border) link(e);
+    return true;
+   }
+   /*function to recompute the diagonal crossings where cluster k meets the clusters right,
+   below and diagonally below it,a crossing is only needed when both cells beside it are blocked
+   */
+   bool buildcorner(int k){
+    int r0,c0,r1,c1;
+    clusterbounds(k,r0,c0,r1,c1);
+    vector<pair<int,int>> old;
+    old.swap(corners[k]);
+    int a=cellindex(r1-1,c1-1);
+    int b=a+1;
+    int c=a+COL;
+    int d=c+1;
+    if(isfree(a)&&isfree(d)&&!isfree(b)&&!isfree(c)) corners[k].push_back({a,d});
+    if(isfree(b)&&isfree(c)&&!isfree(a)&&!isfree(d)) corners[k].push_back({b,c});
+    if(corners[k]==old) return false;
+    for(auto &e:old) unlink(e);
+    for(auto &e:corners[k]) link(e);
+    return true;
+   }
+   //function to recompute the edges between the entrances of cluster k
+   void buildcluster(int k){
+    vector<int> entrances;
+    auto collect=[&](const vector<pair<int,int>>&crossings){
+        for(auto &e:crossings){
+            if(clusterof(e.first)==k) entrances.push_back(e.first);
+            if(clusterof(e.second)==k) entrances.push_back(e.second);
+        }
+    };
+    bool up=k>=clustercols;
+    bool left=k%clustercols>0;
+    collect(hborders[k]);
+    collect(vborders[k]);
+    collect(corners[k]);
+    if(up) collect(hborders[k-clustercols]);
+    if(left) collect(vborders[k-1]);
+    if(left) collect(corners[k-1]);
+    if(up) collect(corners[k-clustercols]);
+    if(up&&left) collect(corners[k-clustercols-1]);
+    sort(entrances.begin(),entrances.end());
+    entrances.erase(unique(entrances.begin(),entrances.end()),entrances.end());
+    intra[k].clear();
+    for(int a:entrances){
+        localsearch(k,a,-1);
+        vector<pair<int,double>> &edges=intra[k][a];
+        for(int b:entrances){
+            double g=localdistance(k,b);
+            if(b!=a&&g<DBL_MAX) edges.push_back({b,g});
+        }
+    }
+   }
+   //function to build the whole abstraction from scratch
+   void build(){
+    int clusters=clusterrows*clustercols;
+    hborders.assign(clusters,{});
+    vborders.assign(clusters,{});
+    corners.assign(clusters,{});
+    intra.assign(clusters,{});
+    inter.clear();
+    for(int k=0;k<clusters;k++){
+        if(k/clustercols+1<clusterrows) buildborder(k,true);
+        if(k%clustercols+1<clustercols) buildborder(k,false);
+        if(k/clustercols+1<clusterrows&&k%clustercols+1<clustercols) buildcorner(k);
+    }
+    for(int k=0;k<clusters;k++) buildcluster(k);
+    rebuilt=clusters;
+   }
+   /*function to block(0) or unblock(1) one cell and repair the abstraction around it
+   the cell's own cluster always gets new intra edges,a neighbouring cluster only does if the
+   border they share lost or gained entrances,returns the number of clusters recomputed
+   */
+   int setcell(int row,int col,int value){
+    rebuilt=0;
+    if(grid[row][col]==value) return 0;
+    grid[row][col]=value;
+    int k=clusterof(cellindex(row,col));
+    int r0,c0,r1,c1;
+    clusterbounds(k,r0,c0,r1,c1);
+    bool down=k/clustercols+1<clusterrows;
+    bool up=k>=clustercols;
+    bool right=k%clustercols+1<clustercols;
+    bool left=k%clustercols>0;
+    vector<int> dirty={k};
+    if(row==r1-1&&down&&buildborder(k,true)) dirty.push_back(k+clustercols);
+    if(row==r0&&up&&buildborder(k-clustercols,true)) dirty.push_back(k-clustercols);
+    if(col==c1-1&&right&&buildborder(k,false)) dirty.push_back(k+1);
+    if(col==c0&&left&&buildborder(k-1,false)) dirty.push_back(k-1);
+    //a corner crossing touches all four clusters around the corner
+    auto corner=[&](int topleft){
+        if(buildcorner(topleft)){
+            int around[4]={topleft,topleft+1,topleft+clustercols,topleft+clustercols+1};
+            dirty.insert(dirty.end(),around,around+4);
+        }
+    };
+    if(row==r1-1&&col==c1-1&&down&&right) corner(k);
+    if(row==r1-1&&col==c0&&down&&left) corner(k-1);
+    if(row==r0&&col==c1-1&&up&&right) corner(k-clustercols);
+    if(row==r0&&col==c0&&up&&left) corner(k-clustercols-1);
+    sort(dirty.begin(),dirty.end());
+    dirty.erase(unique(dirty.begin(),dirty.end()),dirty.end());
+    for(int d:dirty) buildcluster(d);
+    rebuilt=dirty.size();
+    return rebuilt;
+   }
+   /*function to find a path on the abstract graph,returns false if dest cannot be reached
+   abstractpath gets source,the entrances used in order and destination
+   source and destination are joined to the entrances of their clusters for this query only
+   */
+   bool findabstractpath(Pair src,Pair dest,vector<Pair>&abstractpath,double&cost){
+    abstractpath.clear();
+    int s=cellindex(src.first,src.second);
+    int t=cellindex(dest.first,dest.second);
+    if(!isfree(s)||!isfree(t)) return false;
+    if(s==t){
+        abstractpath.push_back(src);
+        cost=0;
+        return true;
+    }
+    int ks=clusterof(s);
+    int kt=clusterof(t);
+    vector<pair<int,double>> srcedges;
+    localsearch(ks,s,-1);
+    for(auto &e:intra[ks]){
+        double g=localdistance(ks,e.first);
+        if(e.first!=s&&g<DBL_MAX) srcedges.push_back({e.first,g});
+    }
+    if(ks==kt&&localdistance(ks,t)<DBL_MAX) srcedges.push_back({t,localdistance(ks,t)});
+    unordered_map<int,double> destedges;
+    localsearch(kt,t,-1);
+    for(auto &e:intra[kt]){
+        double g=localdistance(kt,e.first);
+        if(g<DBL_MAX) destedges[e.first]=g;
+    }
+    abstractg.clear();
+    abstractparent.clear();
+    abstractclosed.clear();
+    abstractopen.clear();
+    abstractg[s]=0;
+    abstractparent[s]=s;
+    abstractopen.push(s,heuristic(s,t));
+    auto relax=[&](int from,int to,double step){
+        if(abstractclosed.count(to)) return;
+        double gnew=abstractg[from]+step;
+        auto it=abstractg.find(to);
+        if(it==abstractg.end()||gnew<it->second){
+            abstractg[to]=gnew;
+            abstractparent[to]=from;
+            abstractopen.push(to,gnew+heuristic(to,t));
+        }
+    };
+    while(!abstractopen.empty()){
+        int x=abstractopen.pop();
+        if(x==t){
+            cost=abstractg[t];
+            for(int v=t;;v=abstractparent[v]){
+                abstractpath.push_back(make_pair(v/COL,v%COL));
+                if(v==s) break;
             }
+            reverse(abstractpath.begin(),abstractpath.end());
+            abstractopen.clear();
+            return true;
         }
-       
-       }
-       //6th successor-(i-1,j+1)
-
-       if(isvalid(i-1,j+1)){
-
-        if(isdestination(i-1,j+1,dest)){
-            celldetails[i-1][j+1].parent_i=i;
-            celldetails[i-1][j+1].parent_j=j;
-            cout<<"destination is found"<<endl;
-            tracepath(celldetails,dest);
-            found_dest=true;
-            return;
-        }
-        else if(closedlist[i-1][j+1]==false&&isunblocked(i-1,j+1,grid)){
-            gnew=celldetails[i][j].g+sqrt(2);
-            hnew=calculatehvalue(i-1,j+1,dest);
-            fnew=gnew+hnew;
-            if(celldetails[i-1][j+1].f==FLT_MAX||celldetails[i-1][j+1].f>fnew){
-                openlist.push(make_pair(fnew,make_pair(i-1,j+1)));
-                celldetails[i-1][j+1].g=gnew;
-                celldetails[i-1][j+1].h=hnew;
-                celldetails[i-1][j+1].f=fnew;
-                celldetails[i-1][j+1].parent_i=i;
-                celldetails[i-1][j+1].parent_j=j;
+        abstractclosed.insert(x);
+        if(x==s){
+            for(auto &e:srcedges) relax(x,e.first,e.second);
+        }
+        else{
+            auto it=intra[clusterof(x)].find(x);
+            if(it!=intra[clusterof(x)].end()) for(auto &e:it->second) relax(x,e.first,e.second);
+        }
+        auto across=inter.find(x);
+        if(across!=inter.end()){
+            for(int y:across->second) relax(x,y,(x/COL!=y/COL&&x%COL!=y%COL)?M_SQRT2:1.0);
+        }
+        auto last=destedges.find(x);
+        if(last!=destedges.end()) relax(x,t,last->second);
+    }
+    return false;
+   }
+   //function to turn an abstract path into the cell by cell path it stands for
+   void refinepath(const vector<Pair>&abstractpath,vector<Pair>&path){
+    path.clear();
+    if(abstractpath.empty()) return;
+    path.push_back(abstractpath[0]);
+    for(size_t n=1;n<abstractpath.size();n++){
+        Pair a=abstractpath[n-1];
+        Pair b=abstractpath[n];
+        //cells joined across a border or corner are next to each other
+        if(max(abs(a.first-b.first),abs(a.second-b.second))<=1){
+            path.push_back(b);
+            continue;
+        }
+        //every other abstract edge stays inside one cluster
+        int from=cellindex(a.first,a.second);
+        int to=cellindex(b.first,b.second);
+        int k=clusterof(from);
+        int r0,c0,r1,c1;
+        clusterbounds(k,r0,c0,r1,c1);
+        localsearch(k,from,to);
+        size_t mark=path.size();
+        for(int l=(b.first-r0)*CLUSTER+(b.second-c0);localparent[l]!=-1;l=localparent[l]){
+            path.push_back(make_pair(r0+l/CLUSTER,c0+l%CLUSTER));
+        }
+        reverse(path.begin()+mark,path.end());
+    }
+   }
+};
+/*incremental replanner (D* Lite) that keeps the search state of one route
+it searches backwards from the destination,so when cells change only the part of the
+search tree whose distances actually changed is expanded again,and the vehicle can move
+along the route without invalidating anything (km absorbs the change of the heuristic)
+state is only kept for cells the route has touched,so many routes can share one grid
+*/
+class DSTARLITE{
+public:
+   typedef pair<double,double> Key;
+   struct node{
+    double g,rhs;
+    Key queued;//key of the valid open list entry of this cell
+    bool inqueue;
+   };
+   const vector<vector<int>> &grid;
+   int ROW,COL;
+   Pair start,goal;
+   double km;
+   unordered_map<int,node> state;
+   priority_queue<pair<Key,int>,vector<pair<Key,int>>,greater<pair<Key,int>>> openlist;
+   //cells expanded by the last plan or update
+   int expanded;
+   DSTARLITE(const vector<vector<int>>&grid,int row,int col,Pair src,Pair dest):grid(grid),ROW(row),COL(col),
+      start(src),goal(dest),km(0),expanded(0){
+    node &n=at(cellindex(goal.first,goal.second));
+    n.rhs=0;
+    enqueue(cellindex(goal.first,goal.second));
+   }
 
+   int cellindex(int row,int col){
+    return row*COL+col;
+   }
+   //function to get the state of a cell,cells never touched have g=rhs=infinity
+   node& at(int index){
+    auto it=state.find(index);
+    if(it!=state.end()) return it->second;
+    return state[index]=node{DBL_MAX,DBL_MAX,Key(0,0),false};
+   }
+   /*D* Lite relies on exact ties between keys,so diagonals are rounded to the same fixed point
+   units as the radix queue,every g,rhs,h and km is then a sum of exactly representable values
+   */
+   static double diagonal(){
+    return RadixQueue::tokey(M_SQRT2)/(double)RadixQueue::FIXEDSCALE;
+   }
+   double heuristic(int index){
+    int di=abs(index/COL-start.first);
+    int dj=abs(index%COL-start.second);
+    return (double)(max(di,dj)-min(di,dj))+diagonal()*min(di,dj);
+   }
+   Key calculatekey(int index){
+    node &n=at(index);
+    double m=min(n.g,n.rhs);
+    if(m==DBL_MAX) return Key(DBL_MAX,DBL_MAX);
+    return Key(m+heuristic(index)+km,m);
+   }
+   //function to put a cell on the open list,an older entry of it just becomes stale
+   void enqueue(int index){
+    node &n=at(index);
+    n.queued=calculatekey(index);
+    n.inqueue=true;
+    openlist.push({n.queued,index});
+   }
+   //function to drop stale entries from the top of the open list
+   bool topvalid(){
+    while(!openlist.empty()){
+        auto &top=openlist.top();
+        node &n=at(top.second);
+        if(n.inqueue&&n.queued==top.first) return true;
+        openlist.pop();
+    }
+    return false;
+   }
+   //function to get the cost of moving between two neighbouring cells
+   double cost(int a,int b){
+    if(grid[a/COL][a%COL]!=1||grid[b/COL][b%COL]!=1) return DBL_MAX;
+    return (a/COL!=b/COL&&a%COL!=b%COL)?diagonal():1.0;
+   }
+   //function to visit the up to 8 neighbours of a cell
+   template<class Visit>
+   void forneighbours(int index,Visit visit){
+    int i=index/COL;
+    int j=index%COL;
+    for(int d=0;d<8;d++){
+        int ni=i+DIRS[d].di;
+        int nj=j+DIRS[d].dj;
+        if(ni>=0&&ni<ROW&&nj>=0&&nj<COL) visit(cellindex(ni,nj));
+    }
+   }
+   //function to recompute rhs of a cell from its neighbours and queue it if it is inconsistent
+   void updatevertex(int index){
+    if(index!=cellindex(goal.first,goal.second)){
+        double best=DBL_MAX;
+        forneighbours(index,[&](int s){
+            double c=cost(index,s);
+            auto it=state.find(s);
+            if(c==DBL_MAX||it==state.end()||it->second.g==DBL_MAX) return;
+            best=min(best,c+it->second.g);
+        });
+        at(index).rhs=best;
+    }
+    node &n=at(index);
+    if(n.g!=n.rhs) enqueue(index);
+    else n.inqueue=false;
+   }
+   //function to expand cells until the start cell is consistent,returns cells expanded
+   int computeshortestpath(){
+    expanded=0;
+    int s=cellindex(start.first,start.second);
+    while(topvalid()){
+        pair<Key,int> top=openlist.top();
+        node &sn=at(s);
+        if(!(top.first<calculatekey(s))&&sn.rhs<=sn.g) break;
+        int u=top.second;
+        Key knew=calculatekey(u);
+        if(top.first<knew){
+            enqueue(u);
+            continue;
+        }
+        openlist.pop();
+        expanded++;
+        node &n=at(u);
+        n.inqueue=false;
+        if(n.g>n.rhs){
+            n.g=n.rhs;
+            forneighbours(u,[&](int p){updatevertex(p);});
+        }
+        else{
+            n.g=DBL_MAX;
+            updatevertex(u);
+            forneighbours(u,[&](int p){updatevertex(p);});
+        }
+    }
+    return expanded;
+   }
+   //function to compute the first route,returns cells expanded
+   int plan(){
+    return computeshortestpath();
+   }
+   //function to move the start of the route to where the vehicle is now
+   void movestart(Pair newstart){
+    int old=cellindex(start.first,start.second);
+    start=newstart;
+    km+=heuristic(old);
+   }
+   /*function to repair the route after the caller changed some cells of the grid
+   every edge into or out of a changed cell has a new cost,so the cell and its
+   neighbours get their rhs recomputed,returns the number of cells expanded again
+   */
+   int updatecells(const vector<Pair>&changed){
+    for(const Pair &c:changed){
+        int index=cellindex(c.first,c.second);
+        updatevertex(index);
+        forneighbours(index,[&](int p){updatevertex(p);});
+    }
+    return computeshortestpath();
+   }
+   //function to read the current route by following the cheapest neighbour,false if there is none
+   bool getpath(vector<Pair>&path){
+    path.clear();
+    int s=cellindex(start.first,start.second);
+    int t=cellindex(goal.first,goal.second);
+    if(at(s).rhs==DBL_MAX) return false;
+    path.push_back(start);
+    while(s!=t){
+        int next=-1;
+        double best=DBL_MAX;
+        forneighbours(s,[&](int n){
+            double c=cost(s,n);
+            auto it=state.find(n);
+            if(c==DBL_MAX||it==state.end()||it->second.g==DBL_MAX) return;
+            if(c+it->second.g<best){
+                best=c+it->second.g;
+                next=n;
             }
+        });
+        if(next<0||(int)path.size()>ROW*COL) return false;
+        s=next;
+        path.push_back(make_pair(s/COL,s%COL));
+    }
+    return true;
+   }
+   //function to get the cost of the current route,the start cell itself may never be expanded
+   //so its one step lookahead rhs is the value that is guaranteed to be current
+   double pathcost(){
+    return at(cellindex(start.first,start.second)).rhs;
+   }
+};
+/*work stealing thread pool
+every worker owns a deque of task numbers,it takes work from the back of its own deque and
+when that runs dry steals from the front of the others,so uneven tasks (long and short trips)
+still keep every core busy,the calling thread takes part as worker 0
+*/
+class WORKSTEALINGPOOL{
+private:
+   struct taskdeque{
+    mutex lock;
+    deque<int> tasks;
+   };
+   vector<unique_ptr<taskdeque>> deques;
+   vector<thread> threads;
+   function<void(int,int)> job;
+   mutex state;
+   condition_variable started,finished;
+   int round;
+   int running;
+   bool stopping;
+   bool takeown(int worker,int&task){
+    taskdeque &d=*deques[worker];
+    lock_guard<mutex> guard(d.lock);
+    if(d.tasks.empty()) return false;
+    task=d.tasks.back();
+    d.tasks.pop_back();
+    return true;
+   }
+   bool steal(int worker,int&task){
+    int n=deques.size();
+    for(int k=1;k<n;k++){
+        taskdeque &d=*deques[(worker+k)%n];
+        lock_guard<mutex> guard(d.lock);
+        if(d.tasks.empty()) continue;
+        task=d.tasks.front();
+        d.tasks.pop_front();
+        return true;
+    }
+    return false;
+   }
+   //function to run tasks until every deque is empty,no task creates new ones
+   void work(int worker){
+    int task;
+    while(takeown(worker,task)||steal(worker,task)) job(worker,task);
+   }
+   void loop(int worker){
+    int seen=0;
+    while(true){
+        {
+            unique_lock<mutex> guard(state);
+            started.wait(guard,[&]{return stopping||round!=seen;});
+            if(stopping) return;
+            seen=round;
         }
-       
-       }
-       //7th successor-(i+1,j+1)
-       if(isvalid(i+1,j+1)){
-        if(isdestination(i+1,j+1,dest)){
-            celldetails[i+1][j+1].parent_i=i;
-            celldetails[i+1][j+1].parent_j=j;
-            cout<<"destination is found"<<endl;
-            tracepath(celldetails,dest);
-            found_dest=true;
-            return;
-        }
-        else if(closedlist[i+1][j+1]==false&&isunblocked(i+1,j+1,grid)){
-            gnew=celldetails[i][j].g+sqrt(2);
-            hnew=calculatehvalue(i+1,j+1,dest);
-            fnew=gnew+hnew;
-            if(celldetails[i+1][j+1].f==FLT_MAX||celldetails[i+1][j+1].f>fnew){
-                openlist.push(make_pair(fnew,make_pair(i+1,j+1)));
-                celldetails[i+1][j+1].g=gnew;
-                celldetails[i+1][j+1].h=hnew;
-                celldetails[i+1][j+1].f=fnew;
-                celldetails[i+1][j+1].parent_i=i;
-                celldetails[i+1][j+1].parent_j=j;
+        work(worker);
+        lock_guard<mutex> guard(state);
+        if(--running==0) finished.notify_one();
+    }
+   }
+public:
+   explicit WORKSTEALINGPOOL(int workers):round(0),running(0),stopping(false){
+    workers=max(workers,1);
+    for(int w=0;w<workers;w++) deques.push_back(make_unique<taskdeque>());
+    for(int w=1;w<workers;w++) threads.emplace_back(&WORKSTEALINGPOOL::loop,this,w);
+   }
+   ~WORKSTEALINGPOOL(){
+    {
+        lock_guard<mutex> guard(state);
+        stopping=true;
+    }
+    started.notify_all();
+    for(thread &t:threads) t.join();
+   }
+   int size() const{
+    return deques.size();
+   }
+   //function to run fn(worker,task) for every task in 0..tasks-1 and wait for all of them
+   void run(int tasks,function<void(int,int)> fn){
+    job=move(fn);
+    int n=deques.size();
+    //deal contiguous blocks so neighbouring tasks start on the same worker
+    for(int w=0;w<n;w++){
+        lock_guard<mutex> guard(deques[w]->lock);
+        for(int t=(long long)tasks*w/n;t<(long long)tasks*(w+1)/n;t++) deques[w]->tasks.push_back(t);
+    }
+    {
+        lock_guard<mutex> guard(state);
+        running=n-1;
+        round++;
+    }
+    started.notify_all();
+    work(0);
+    unique_lock<mutex> guard(state);
+    finished.wait(guard,[&]{return running==0;});
+   }
+};
+/*answer to one query of a batch,the cells of the path are flat cell indices in order
+from source to destination,they live in the arena of the worker that solved the query
+and stay valid until the next batch,length is 0 if there is no path
+*/
+struct PathResult{
+   double cost;
+   const int *cells;
+   int length;
+};
+/*batch engine answering many (src,dest) queries over one read-only grid
+every worker keeps its own ASTARSEARCHALGORITHM workspace and its own arena for path cells,
+so the only thing the workers share is the grid (and the jump point bitmaps if used)
+*/
+template<class Grid>
+class BATCHASTAR{
+public:
+   //queries handed out as one task,small enough to balance,large enough to amortise a steal
+   static const int CHUNK=16;
+   const Grid &grid;
+   int ROW,COL;
+   WORKSTEALINGPOOL pool;
+   vector<unique_ptr<ASTARSEARCHALGORITHM>> planners;
+   vector<vector<int>> arenas;
+   BATCHASTAR(const Grid&grid,int row,int col,int workers,OpenListKind kind=DARY_HEAP,SearchMode mode=PLAIN_ASTAR)
+      :grid(grid),ROW(row),COL(col),pool(workers){
+    for(int w=0;w<pool.size();w++) planners.push_back(make_unique<ASTARSEARCHALGORITHM>(row,col,kind,mode));
+    arenas.resize(pool.size());
+    if(mode==JUMP_POINT&&!hascellcosts(grid)){
+        planners[0]->preparejumpsearch(grid);
+        for(int w=1;w<pool.size();w++) planners[w]->sharejumpsearch(*planners[0]);
+    }
+   }
+   //function to let every worker use the same landmark lower bounds
+   void uselandmarks(const GRIDLANDMARKS*table){
+    for(auto &planner:planners) planner->uselandmarks(table);
+   }
+   //function to answer a batch of queries,results[q] answers queries[q]
+   void solve(const vector<pair<Pair,Pair>>&queries,vector<PathResult>&results){
+    int n=queries.size();
+    results.assign(n,PathResult{0,nullptr,0});
+    //while the batch runs cells holds the offset into the arena,pointers are fixed up after
+    vector<int> owner(n),offset(n);
+    for(auto &arena:arenas) arena.clear();
+    pool.run((n+CHUNK-1)/CHUNK,[&](int worker,int task){
+        vector<int> &arena=arenas[worker];
+        for(int q=task*CHUNK;q<min(n,(task+1)*CHUNK);q++){
+            size_t mark=arena.size();
+            double cost;
+            if(planners[worker]->findpath(grid,queries[q].first,queries[q].second,arena,cost)){
+                results[q].cost=cost;
+                results[q].length=arena.size()-mark;
             }
+            owner[q]=worker;
+            offset[q]=mark;
         }
-      
-       }
-       //8th successor-(i+1,j-1)
-       if(isvalid(i+1,j-1)){
-        if(isdestination(i+1,j-1,dest)){
-            celldetails[i+1][j-1].parent_i=i;
-            celldetails[i+1][j-1].parent_j=j;
-            cout<<"destination is found"<<endl;
-            tracepath(celldetails,dest);
-            found_dest=true;
-            return;
-        }
-        else if(closedlist[i+1][j-1]==false&&isunblocked(i+1,j-1,grid)){
-            gnew=celldetails[i][j].g+sqrt(2);
-            hnew=calculatehvalue(i+1,j-1,dest);
-            fnew=gnew+hnew;
-            if(celldetails[i+1][j-1].f==FLT_MAX||celldetails[i+1][j-1].f>fnew){
-                openlist.push(make_pair(fnew,make_pair(i+1,j+1)));
-                celldetails[i+1][j-1].g=gnew;
-                celldetails[i+1][j-1].h=hnew;
-                celldetails[i+1][j-1].f=fnew;
-                celldetails[i+1][j-1].parent_i=i;
-                celldetails[i+1][j-1].parent_j=j;
-
+    });
+    for(int q=0;q<n;q++){
+        if(results[q].length>0) results[q].cells=arenas[owner[q]].data()+offset[q];
+    }
+   }
+};
+//function to build landmarks into table when count is positive,returns the table to use or null
+template<class Grid>
+const GRIDLANDMARKS* preparelandmarks(const Grid&grid,int ROW,int COL,int count,GRIDLANDMARKS&table){
+    if(count<=0) return nullptr;
+    table.build(grid,ROW,COL,count);
+    return &table;
+}
+/*function to answer "src_i src_j dest_i dest_j" queries from standard input until it ends
+queries are read and answered in blocks so output starts before the input ends
+*/
+template<class Grid>
+void runbatch(const Grid&grid,int ROW,int COL,int threads,OpenListKind kind,SearchMode mode,int landmarkcount){
+    const int BLOCK=1<<14;
+    BATCHASTAR<Grid> engine(grid,ROW,COL,threads,kind,mode);
+    GRIDLANDMARKS table;
+    engine.uselandmarks(preparelandmarks(grid,ROW,COL,landmarkcount,table));
+    vector<pair<Pair,Pair>> queries;
+    vector<PathResult> results;
+    int si,sj,di,dj;
+    bool more=true;
+    while(more){
+        queries.clear();
+        while((int)queries.size()<BLOCK&&(more=(bool)(cin>>si>>sj>>di>>dj))) queries.push_back({{si,sj},{di,dj}});
+        if(queries.empty()) break;
+        engine.solve(queries,results);
+        for(const PathResult &r:results){
+            if(r.length==0){
+                cout<<"no path\n";
+                continue;
+            }
+            cout<<r.cost<<' ';
+            for(int k=0;k<r.length;k++){
+                cout<<"("<<r.cells[k]/COL<<","<<r.cells[k]%COL<<")";
+                if(k+1<r.length) cout<<"->";
             }
-            
+            cout<<'\n';
         }
-       
-       }
     }
-    if(found_dest==false){
+}
+/*function to answer one query with the anytime search,printing the cost and proven bound
+of every path it improves on and then the best path it found within the budget
+*/
+template<class Grid>
+void runanytime(const Grid&grid,int ROW,int COL,Pair src,Pair dest,double weight,double budget,int landmarkcount){
+    ASTARSEARCHALGORITHM X(ROW,COL);
+    GRIDLANDMARKS table;
+    X.uselandmarks(preparelandmarks(grid,ROW,COL,landmarkcount,table));
+    vector<int> cells;
+    double cost,bound;
+    bool found=X.anytimepath(grid,src,dest,weight,budget,cells,cost,bound,[](const vector<int>&,double cost,double bound){
+        cout<<"path of cost "<<cost<<" within "<<bound<<" of optimal"<<endl;
+    });
+    if(!found){
         cout<<"failed to find destination cell"<<endl;
         return;
     }
-
-   }
-
-   void implement_a_star_search(vector<vector<int>>grid,Pair src,Pair dest){
-    astareach(grid,src,dest);
-    return;
-   }
-
-
-
-   
-   
-
-};
+    cout<<"destination cell is found"<<endl;
+    vector<Pair> path;
+    for(int index:cells) path.push_back(make_pair(index/COL,index%COL));
+    printpath(path);
+}
+//other programs include this file with OPTIRIDE_NO_MAIN defined to use the searches
+#ifndef OPTIRIDE_NO_MAIN
 //main function
-int main(){
+//pass --radix to use the bucket queue open list instead of the d-ary heap
+//pass --jps to use jump point search instead of plain A*
+//pass --bidir to search from both ends at once with bidirectional A*
+//pass --hpa N to answer the query on a hierarchical abstraction with N x N clusters
+//pass --replan to keep the route and then read batches of changes,a count k followed by
+//k lines "i j value",printing the repaired route after every batch
+//pass --batch [--threads N] to read "src_i src_j dest_i dest_j" queries until the end of input
+//and answer them on N threads,one line "cost path" or "no path" per query in input order
+//pass --map FILE to memory map a binary map instead of reading the grid from input,
+//only plain,--jps,--bidir,--anytime and --batch queries run on a mapped map
+//pass --with-costs to read a second ROW x COL matrix of traversal costs after the grid,
+//a step then costs its length times the cost of the cell it enters (plain,--batch and --anytime only)
+//pass --convert FILE [--with-costs] to write the grid read from input as a binary map
+//pass --anytime MS [--weight W] to search with ARA*,starting W times optimal (default 2)
+//and improving the path until MS milliseconds have passed
+//pass --landmarks K to raise the heuristic of plain,--bidir,--anytime and --batch queries
+//with lower bounds from K landmark cells (not used with --radix)
+int main(int argc,char**argv){
+    ios::sync_with_stdio(false);
+    OpenListKind kind=DARY_HEAP;
+    SearchMode mode=PLAIN_ASTAR;
+    int cluster=0;
+    bool replan=false;
+    bool batch=false;
+    bool withcosts=false;
+    double budget=-1,weight=2;
+    int landmarkcount=0;
+    string mapfile,convertfile;
+    int threads=max(1u,thread::hardware_concurrency());
+    for(int a=1;a<argc;a++){
+        if(string(argv[a])=="--radix") kind=RADIX_QUEUE;
+        if(string(argv[a])=="--jps") mode=JUMP_POINT;
+        if(string(argv[a])=="--bidir") mode=BIDIRECTIONAL;
+        if(string(argv[a])=="--hpa"&&a+1<argc) cluster=atoi(argv[++a]);
+        else if(string(argv[a])=="--replan") replan=true;
+        else if(string(argv[a])=="--batch") batch=true;
+        else if(string(argv[a])=="--threads"&&a+1<argc) threads=atoi(argv[++a]);
+        else if(string(argv[a])=="--map"&&a+1<argc) mapfile=argv[++a];
+        else if(string(argv[a])=="--convert"&&a+1<argc) convertfile=argv[++a];
+        else if(string(argv[a])=="--with-costs") withcosts=true;
+        else if(string(argv[a])=="--anytime"&&a+1<argc) budget=atof(argv[++a]);
+        else if(string(argv[a])=="--weight"&&a+1<argc) weight=atof(argv[++a]);
+        else if(string(argv[a])=="--landmarks"&&a+1<argc) landmarkcount=atoi(argv[++a]);
+    }
+    if(!mapfile.empty()){
+        BITGRID map;
+        string error;
+        if(!map.open(mapfile,error)){
+            cout<<error<<endl;
+            return 1;
+        }
+        if(batch){
+            runbatch(map,map.ROW,map.COL,threads,kind,mode,landmarkcount);
+            return 0;
+        }
+        Pair src,dest;
+        cin>>src.first>>src.second>>dest.first>>dest.second;
+        if(budget>=0){
+            runanytime(map,map.ROW,map.COL,src,dest,weight,budget,landmarkcount);
+            return 0;
+        }
+        ASTARSEARCHALGORITHM X(map.ROW,map.COL,kind,mode);
+        GRIDLANDMARKS table;
+        X.uselandmarks(preparelandmarks(map,map.ROW,map.COL,landmarkcount,table));
+        X.implement_a_star_search(map,src,dest);
+        return 0;
+    }
     int ROW,COL;
     cin>>ROW;
     cin>>COL;
@@ -477,6 +2181,26 @@ int main(){
     for(int i=0;i<ROW;i++){
         for(int j=0;j<COL;j++) cin>>grid[i][j];
     }
+    vector<vector<int>> costs;
+    if(withcosts){
+        costs.assign(ROW,vector<int>(COL));
+        for(int i=0;i<ROW;i++){
+            for(int j=0;j<COL;j++) cin>>costs[i][j];
+        }
+    }
+    if(!convertfile.empty()){
+        string error;
+        if(!BITGRID::write(convertfile,grid,ROW,COL,withcosts?&costs:nullptr,error)){
+            cout<<error<<endl;
+            return 1;
+        }
+        return 0;
+    }
+    if(batch){
+        if(withcosts) runbatch(COSTGRID(grid,costs,ROW,COL),ROW,COL,threads,kind,mode,landmarkcount);
+        else runbatch(grid,ROW,COL,threads,kind,mode,landmarkcount);
+        return 0;
+    }
     int source_i,source_j;//coordinates of starting point
     int dest_i,dest_j;//coordinates of destination point
     cin>>source_i;
@@ -485,12 +2209,72 @@ int main(){
     cin>>dest_j;
     Pair src=make_pair(source_i,source_j);// pair containing coordinates
     Pair dest=make_pair(dest_i,dest_j);
-    ASTARSEARCHALGORITHM X(ROW,COL);
+    if(replan){
+        if(src.first<0||src.first>=ROW||src.second<0||src.second>=COL||grid[src.first][src.second]!=1
+            ||dest.first<0||dest.first>=ROW||dest.second<0||dest.second>=COL||grid[dest.first][dest.second]!=1){
+            cout<<"source or destination is invalid or blocked"<<endl;
+            return 0;
+        }
+        DSTARLITE route(grid,ROW,COL,src,dest);
+        int expandedcells=route.plan();
+        vector<Pair> changed,path;
+        while(true){
+            cout<<"expanded "<<expandedcells<<" cells"<<endl;
+            if(route.getpath(path)) printpath(path);
+            else cout<<"failed to find destination cell"<<endl;
+            int k;
+            if(!(cin>>k)) break;
+            changed.clear();
+            for(int c=0;c<k;c++){
+                int i,j,value;
+                cin>>i>>j>>value;
+                if(i<0||i>=ROW||j<0||j>=COL) continue;
+                grid[i][j]=value;
+                changed.push_back(make_pair(i,j));
+            }
+            expandedcells=route.updatecells(changed);
+        }
+        return 0;
+    }
+    if(cluster>0){
+        if(src.first<0||src.first>=ROW||src.second<0||src.second>=COL||grid[src.first][src.second]!=1
+            ||dest.first<0||dest.first>=ROW||dest.second<0||dest.second>=COL||grid[dest.first][dest.second]!=1){
+            cout<<"source or destination is invalid or blocked"<<endl;
+            return 0;
+        }
+        HIERARCHICALASTAR H(grid,ROW,COL,cluster);
+        vector<Pair> abstractpath,path;
+        double cost;
+        if(!H.findabstractpath(src,dest,abstractpath,cost)){
+            cout<<"failed to find destination cell"<<endl;
+            return 0;
+        }
+        cout<<"destination cell is found"<<endl;
+        H.refinepath(abstractpath,path);
+        printpath(path);
+        return 0;
+    }
+    if(budget>=0){
+        if(withcosts) runanytime(COSTGRID(grid,costs,ROW,COL),ROW,COL,src,dest,weight,budget,landmarkcount);
+        else runanytime(grid,ROW,COL,src,dest,weight,budget,landmarkcount);
+        return 0;
+    }
+    ASTARSEARCHALGORITHM X(ROW,COL,kind,mode);
+    GRIDLANDMARKS table;
 
-    X.implement_a_star_search(grid,src,dest);
+    if(withcosts){
+        COSTGRID weighted(grid,costs,ROW,COL);
+        X.uselandmarks(preparelandmarks(weighted,ROW,COL,landmarkcount,table));
+        X.implement_a_star_search(weighted,src,dest);
+    }
+    else{
+        X.uselandmarks(preparelandmarks(grid,ROW,COL,landmarkcount,table));
+        X.implement_a_star_search(grid,src,dest);
+    }
 
     return 0;
     
 
 
 }
+#endif
@@ -1,7 +1,8 @@
 #include <iostream>
 #include <vector>
-#include <cmath>   // For sqrt and pow
+#include <cmath>   // For sqrt
 #include <limits>  // For numeric_limits
+#include <algorithm> // For min and max
 
 using namespace std;
 
@@ -11,43 +12,340 @@ struct Point {
     double x, y; // Coordinates of the driver or passenger
 };
 
+
+// Uniform grid over the available drivers for nearest driver lookups close to a driver.
+// Each cell holds its drivers in one slice of a shared array, removing a driver swaps it
+// with the last one of its cell. The grid is built again, coarser, once three quarters
+// of the drivers it was built with are gone so lookups do not wade through empty cells.
+// Only the few rings of cells around a passenger are searched: when the drivers are bunched
+// up somewhere else those would be mostly empty, and DriverTree answers instead
+class DriverGrid {
+public:
+    DriverGrid(const vector<Point>& d) : drivers(d) {
+        vector<int> all(drivers.size());
+        for (int i = 0; i < (int)drivers.size(); i++) all[i] = i;
+        build(all);
+    }
+
+    // Take a driver out, it is never returned again
+    void remove(int driverIndex) {
+        int c = cellOf[driverIndex];
+        int last = cellStart[c] + cellCount[c] - 1;
+        int moved = order[last];
+        order[slot[driverIndex]] = moved;
+        slot[moved] = slot[driverIndex];
+        order[last] = driverIndex;
+        slot[driverIndex] = last;
+        cellCount[c]--;
+        live--;
+        if (live > 0 && live * 4 < built) {
+            vector<int> remaining;
+            remaining.reserve(live);
+            for (int k = 0; k < (int)cellCount.size(); k++) {
+                for (int q = cellStart[k]; q < cellStart[k] + cellCount[k]; q++) remaining.push_back(order[q]);
+            }
+            build(remaining);
+        }
+    }
+
+    // Rings searched before giving up on a lookup
+    static const int RINGS = 8;
+
+    // The closest driver still in the grid, the lowest index among equally close ones, -1 if none is left.
+    // Rings of cells are searched outwards until the next ring cannot hold anything closer. Returns false
+    // when that takes more than RINGS rings, index is then not set
+    bool nearestNearby(const Point& p, int& index) const {
+        index = -1;
+        if (live == 0) return true;
+        int cx = cellX(p.x), cy = cellY(p.y);
+        int reach = max(max(cx, columns - 1 - cx), max(cy, rows - 1 - cy));
+        double best = numeric_limits<double>::max();
+        int bestIndex = -1;
+        for (int r = 0; r <= reach; r++) {
+            // Every cell in ring r is at least r - 1 cells away in x or y
+            double gap = (r - 1) * cellSize;
+            if (r > 1 && gap * gap > best) break;
+            if (r > RINGS) return false;
+            for (int y = cy - r; y <= cy + r; y++) {
+                if (y < 0 || y >= rows) continue;
+                // Only the two end cells of the rows between the top and bottom of the ring
+                int step = (y == cy - r || y == cy + r) ? 1 : max(1, 2 * r);
+                for (int x = cx - r; x <= cx + r; x += step) {
+                    if (x < 0 || x >= columns) continue;
+                    int c = y * columns + x;
+                    for (int q = cellStart[c]; q < cellStart[c] + cellCount[c]; q++) {
+                        int i = order[q];
+                        double dx = p.x - drivers[i].x, dy = p.y - drivers[i].y;
+                        double distance = dx * dx + dy * dy;
+                        if (distance < best || (distance == best && i < bestIndex)) {
+                            best = distance;
+                            bestIndex = i;
+                        }
+                    }
+                }
+            }
+        }
+        index = bestIndex;
+        return true;
+    }
+
+private:
+    const vector<Point>& drivers;
+    double minX = 0, minY = 0, cellSize = 1;
+    int columns = 1, rows = 1;
+    vector<int> cellStart, cellCount; // Drivers of cell c are order[cellStart[c]] .. order[cellStart[c] + cellCount[c] - 1]
+    vector<int> order, slot, cellOf;  // slot[i] is the position of driver i in order
+    int live = 0, built = 0;
+
+    int cellX(double x) const {
+        return (int)min((double)columns - 1, max(0.0, floor((x - minX) / cellSize)));
+    }
+    int cellY(double y) const {
+        return (int)min((double)rows - 1, max(0.0, floor((y - minY) / cellSize)));
+    }
+
+    // About one driver per cell over the bounding box of the given drivers
+    void build(const vector<int>& members) {
+        live = built = members.size();
+        double maxX = 0, maxY = 0;
+        for (int k = 0; k < (int)members.size(); k++) {
+            const Point& d = drivers[members[k]];
+            if (k == 0 || d.x < minX) minX = d.x;
+            if (k == 0 || d.y < minY) minY = d.y;
+            if (k == 0 || d.x > maxX) maxX = d.x;
+            if (k == 0 || d.y > maxY) maxY = d.y;
+        }
+        double width = maxX - minX, height = maxY - minY;
+        // Square cells, never more than one per driver along either side
+        cellSize = max(sqrt(width * height / max(1, live)), max(width, height) / max(1, live));
+        cellSize = max(cellSize, 1e-9);
+        columns = (int)(width / cellSize) + 1;
+        rows = (int)(height / cellSize) + 1;
+
+        cellStart.assign(columns * rows + 1, 0);
+        cellCount.assign(columns * rows, 0);
+        cellOf.assign(drivers.size(), -1);
+        slot.assign(drivers.size(), -1);
+        for (int i : members) {
+            cellOf[i] = cellY(drivers[i].y) * columns + cellX(drivers[i].x);
+            cellCount[cellOf[i]]++;
+        }
+        for (int c = 0; c < columns * rows; c++) cellStart[c + 1] = cellStart[c] + cellCount[c];
+        order.assign(live, -1);
+        vector<int> next(cellStart.begin(), cellStart.end() - 1);
+        for (int i : members) {
+            slot[i] = next[cellOf[i]]++;
+            order[slot[i]] = i;
+        }
+    }
+};
+
+
+// k-d tree over the available drivers for the nearest driver lookups DriverGrid gives up on.
+// Each node splits its drivers at the median of the wider side of its box, leaves hold a few
+// drivers each. Every node counts the drivers it still holds, so a lookup skips subtrees that
+// are empty or whose box is further away than the best driver found, however the drivers are
+// spread. Removing a driver marks it gone, lowers the counts on its path and shrinks the boxes
+// there. The tree is built again once three quarters of the drivers it was built with are gone
+// so leaves do not fill up with drivers that are gone
+class DriverTree {
+public:
+    // The tree starts out empty, build fills it
+    DriverTree(const vector<Point>& d) : drivers(d) {}
+
+    // Hold the given drivers, replacing any there were
+    void build(const vector<int>& members) {
+        order = members;
+        nodes.clear();
+        alive.assign(order.size(), true);
+        slot.assign(drivers.size(), -1);
+        if (order.empty()) return;
+        nodes.reserve(4 * order.size() / LEAF + 2);
+        buildNode(0, order.size());
+        xs.resize(order.size());
+        ys.resize(order.size());
+        for (int q = 0; q < (int)order.size(); q++) {
+            slot[order[q]] = q;
+            xs[q] = drivers[order[q]].x;
+            ys[q] = drivers[order[q]].y;
+        }
+    }
+
+    // Take a driver out, it is never returned again
+    void remove(int driverIndex) {
+        int position = slot[driverIndex];
+        if (position < 0 || !alive[position]) return;
+        alive[position] = false;
+        vector<int> path;
+        for (int n = 0; n != -1;) {
+            Node& node = nodes[n];
+            node.live--;
+            path.push_back(n);
+            if (node.left == -1) break;
+            n = position < nodes[node.left].end ? node.left : node.right;
+        }
+        // Shrink the boxes on the path to the drivers left, the drivers a lookup wants are usually the
+        // ones that go first, and boxes that still cover them would send lookups into emptied corners
+        for (int k = path.size() - 1; k >= 0; k--) {
+            Node& node = nodes[path[k]];
+            if (node.live == 0) continue;
+            node.minX = node.minY = numeric_limits<double>::max();
+            node.maxX = node.maxY = numeric_limits<double>::lowest();
+            if (node.left == -1) {
+                for (int q = node.begin; q < node.end; q++) {
+                    if (alive[q]) include(node, xs[q], ys[q], xs[q], ys[q]);
+                }
+                continue;
+            }
+            for (int child : {node.left, node.right}) {
+                const Node& c = nodes[child];
+                if (c.live > 0) include(node, c.minX, c.minY, c.maxX, c.maxY);
+            }
+        }
+        if (nodes[0].live > 0 && nodes[0].live * 4 < (int)order.size()) {
+            vector<int> remaining;
+            remaining.reserve(nodes[0].live);
+            for (int q = 0; q < (int)order.size(); q++) {
+                if (alive[q]) remaining.push_back(order[q]);
+            }
+            build(remaining);
+        }
+    }
+
+    // The closest driver still in the tree, the lowest index among equally close ones, -1 if none is left
+    int nearest(const Point& p) const {
+        if (nodes.empty() || nodes[0].live == 0) return -1;
+        double best = numeric_limits<double>::max();
+        int bestIndex = -1;
+        search(0, boxDistance(nodes[0], p), p, best, bestIndex);
+        return bestIndex;
+    }
+
+private:
+    static const int LEAF = 32;
+    struct Node {
+        double minX, minY, maxX, maxY; // Box around the drivers the node still holds
+        int begin, end;                // Its drivers are order[begin] .. order[end - 1]
+        int left, right;               // Children, -1 for a leaf
+        int live;                      // Drivers not removed yet
+    };
+    const vector<Point>& drivers;
+    vector<Node> nodes;
+    vector<int> order, slot; // slot[i] is the position of driver i in order, -1 if it is not in the tree
+    vector<bool> alive;      // By position in order
+    vector<double> xs, ys;   // Driver coordinates by position in order, so a leaf reads them in one run
+
+    // Grow the box of a node to cover the given box
+    static void include(Node& node, double minX, double minY, double maxX, double maxY) {
+        node.minX = min(node.minX, minX);
+        node.minY = min(node.minY, minY);
+        node.maxX = max(node.maxX, maxX);
+        node.maxY = max(node.maxY, maxY);
+    }
+
+    // Squared distance from p to the box of a node, 0 inside it
+    static double boxDistance(const Node& node, const Point& p) {
+        double dx = max(0.0, max(node.minX - p.x, p.x - node.maxX));
+        double dy = max(0.0, max(node.minY - p.y, p.y - node.maxY));
+        return dx * dx + dy * dy;
+    }
+
+    // boxGap is the squared distance from p to the box of node n
+    void search(int n, double boxGap, const Point& p, double& best, int& bestIndex) const {
+        const Node& node = nodes[n];
+        // Boxes exactly as far as the best driver are still searched for a lower index
+        if (node.live == 0 || boxGap > best) return;
+        if (node.left == -1) {
+            for (int q = node.begin; q < node.end; q++) {
+                if (!alive[q]) continue;
+                int i = order[q];
+                double dx = p.x - xs[q], dy = p.y - ys[q];
+                double distance = dx * dx + dy * dy;
+                if (distance < best || (distance == best && i < bestIndex)) {
+                    best = distance;
+                    bestIndex = i;
+                }
+            }
+            return;
+        }
+        // The nearer child first so the further one is more likely to be cut off
+        int first = node.left, second = node.right;
+        double firstGap = boxDistance(nodes[first], p), secondGap = boxDistance(nodes[second], p);
+        if (secondGap < firstGap) {
+            swap(first, second);
+            swap(firstGap, secondGap);
+        }
+        search(first, firstGap, p, best, bestIndex);
+        search(second, secondGap, p, best, bestIndex);
+    }
+
+    int buildNode(int begin, int end) {
+        int n = nodes.size();
+        nodes.push_back({0, 0, 0, 0, begin, end, -1, -1, end - begin});
+        double minX = drivers[order[begin]].x, maxX = minX, minY = drivers[order[begin]].y, maxY = minY;
+        for (int q = begin; q < end; q++) {
+            const Point& d = drivers[order[q]];
+            minX = min(minX, d.x);
+            maxX = max(maxX, d.x);
+            minY = min(minY, d.y);
+            maxY = max(maxY, d.y);
+        }
+        nodes[n].minX = minX;
+        nodes[n].minY = minY;
+        nodes[n].maxX = maxX;
+        nodes[n].maxY = maxY;
+        if (end - begin <= LEAF) return n;
+        int middle = begin + (end - begin) / 2;
+        bool alongX = maxX - minX >= maxY - minY;
+        nth_element(order.begin() + begin, order.begin() + middle, order.begin() + end, [&](int a, int b) {
+            return alongX ? drivers[a].x < drivers[b].x : drivers[a].y < drivers[b].y;
+        });
+        int left = buildNode(begin, middle);
+        int right = buildNode(middle, end);
+        nodes[n].left = left;
+        nodes[n].right = right;
+        return n;
+    }
+};
+
 // Class to represent the Ride Sharing Problem
 class RideSharingProblem {
 public:
     vector<Point>& drivers;
     vector<Point>& passengers;
     vector<bool> driverAssigned; // Keeps track of assigned drivers
+    DriverGrid nearbyDrivers;     // Unassigned drivers by location, for passengers with one close by
+    DriverTree availableDrivers;  // The same drivers, for every other passenger. Built by the first of those
+    bool treeBuilt = false;
     
     // Constructor to initialize problem
     RideSharingProblem(vector<Point>& d, vector<Point>& p) 
-        : drivers(d), passengers(p), driverAssigned(d.size(), false) {}
+        : drivers(d), passengers(p), driverAssigned(d.size(), false), nearbyDrivers(d), availableDrivers(d) {}
     
     // Function to calculate the Euclidean distance between two points
-    double calculateDistance(Point a, Point b) {
-        return sqrt(pow(a.x - b.x, 2) + pow(a.y - b.y, 2));
+    double calculateDistance(const Point& a, const Point& b) {
+        double dx = a.x - b.x, dy = a.y - b.y;
+        return sqrt(dx * dx + dy * dy);
     }
     
     // Check if all passengers have been assigned
     bool isComplete(int assignedPassengers) {
-        return assignedPassengers == passengers.size();
+        return assignedPassengers == (int)passengers.size();
     }
 
-    // Find the best choice of driver for a given passenger
+    // Find the best choice of driver for a given passenger: the closest available one
     int findBestChoice(Point& passenger) {
-        double minDistance = numeric_limits<double>::max();
-        int bestDriverIndex = -1;
-
-        // Loop over all drivers to find the closest available one
-        for (int i = 0; i < drivers.size(); i++) {
-            if (!driverAssigned[i]) {  // Only consider unassigned drivers
-                double distance = calculateDistance(passenger, drivers[i]);
-                if (distance < minDistance) {
-                    minDistance = distance;
-                    bestDriverIndex = i;
-                }
+        int driverIndex;
+        if (nearbyDrivers.nearestNearby(passenger, driverIndex)) return driverIndex;
+        if (!treeBuilt) {
+            vector<int> unassigned;
+            for (int i = 0; i < (int)drivers.size(); i++) {
+                if (!driverAssigned[i]) unassigned.push_back(i);
             }
+            availableDrivers.build(unassigned);
+            treeBuilt = true;
         }
-        return bestDriverIndex;
+        return availableDrivers.nearest(passenger);
     }
     
     // Check if the selected driver is valid (in this case, the check is implicit)
@@ -57,7 +355,10 @@ public:
     
     // Update the problem state by marking the driver as assigned
     void updateProblem(int driverIndex) {
+        if (driverAssigned[driverIndex]) return;
         driverAssigned[driverIndex] = true;
+        nearbyDrivers.remove(driverIndex);
+        if (treeBuilt) availableDrivers.remove(driverIndex);
     }
 };
 
@@ -86,6 +387,8 @@ void rideSharingGreedy(RideSharingProblem& problem) {
     }
 }
 
+// Other programs include this file with OPTIRIDE_NO_MAIN defined to use the greedy matcher
+#ifndef OPTIRIDE_NO_MAIN
 int main() {
     int numDrivers, numPassengers;
     
@@ -124,3 +427,4 @@ int main() {
 
     return 0;
 }
+#endif
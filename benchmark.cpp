@@ -0,0 +1,327 @@
+// benchmark suite for the searches and matchers of the other programs, on synthetic cities.
+// every run generates its maps, road graphs and driver and passenger clouds from the seed, times
+// astareach, dijkstra_algo, HungarianAlgorithm::minimizeCost and rideSharingGreedy on them over a range
+// of sizes and prints one JSON line (or CSV row) per benchmark, generator and size.
+// what the timed functions print is thrown away, it is not part of the measurement output
+
+// the matchers, which bring the road graph searches, the greedy matcher and A* with them
+#define OPTIRIDE_NO_MAIN
+#include "hungarian.cpp"
+
+      // stream buffer that drops everything written to it
+class NullBuffer : public streambuf {
+protected:
+    int overflow(int c) override {
+        return traits_type::not_eof(c);
+    }
+    streamsize xsputn(const char*, streamsize n) override {
+        return n;
+    }
+};
+
+      // timings of one benchmark on one generated input
+struct BenchmarkResult {
+    string benchmark, generator;
+    int size = 0;            // side of the map, junctions of the road graph, or drivers and passengers each
+    long long elements = 0;  // free cells reachable, roads, cost matrix entries, or drivers and passengers
+    int calls = 0;           // timed calls per repeat
+    vector<double> samples;  // milliseconds per call, one per repeat
+    double work = 0;         // what the calls computed: cells expanded, total distance or pairs matched.
+                             // it only changes with the seed or the algorithm, so a change flags a behaviour change
+
+    BenchmarkResult(const string& benchmark, const string& generator, int size, long long elements = 0)
+        : benchmark(benchmark), generator(generator), size(size), elements(elements) {}
+};
+
+struct BenchmarkOptions {
+    vector<int> sizes;       // replaces the size range of every benchmark when given
+    string only;             // only the benchmarks whose name contains this
+    int repeats = 3;
+    unsigned long long seed = 1;
+    bool csv = false;
+};
+
+      // runs body repeats times with cout dropped and returns the time of each run divided by calls
+template <class Body>
+vector<double> timeRepeats(int repeats, int calls, Body body) {
+    NullBuffer nothing;
+    streambuf* old = cout.rdbuf(&nothing);
+    vector<double> samples;
+    for (int r = 0; r < repeats; ++r) {
+        auto start = chrono::steady_clock::now();
+        body(r);
+        samples.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / max(calls, 1));
+    }
+    cout.rdbuf(old);
+    return samples;
+}
+
+      // grid maps, side by side cells, 1 free and 0 blocked
+
+      // every cell free with the given chance
+vector<vector<int>> randomMap(int side, double open, FleetRandom& random) {
+    vector<vector<int>> grid(side, vector<int>(side));
+    for (auto& line : grid) {
+        for (int& c : line) c = random.uniform() < open;
+    }
+    return grid;
+}
+
+      // corridors one cell wide carved by a random depth first walk over the odd cells, then one in ten of the
+      // walls left between two corridors knocked out so there is more than one way round
+vector<vector<int>> mazeMap(int side, FleetRandom& random) {
+    vector<vector<int>> grid(side, vector<int>(side, 0));
+    if (side < 2) return grid;
+    static const int STEP[4][2] = {{0, 2}, {0, -2}, {2, 0}, {-2, 0}};
+    vector<pair<int, int>> stack(1, {1, 1});
+    grid[1][1] = 1;
+    while (!stack.empty()) {
+        int i = stack.back().first, j = stack.back().second;
+        int options[4], count = 0;
+        for (int d = 0; d < 4; ++d) {
+            int ni = i + STEP[d][0], nj = j + STEP[d][1];
+            if (ni > 0 && ni < side - 1 && nj > 0 && nj < side - 1 && grid[ni][nj] == 0) options[count++] = d;
+        }
+        if (count == 0) {
+            stack.pop_back();
+            continue;
+        }
+        int d = options[random.below(count)];
+        grid[i + STEP[d][0] / 2][j + STEP[d][1] / 2] = 1;
+        grid[i + STEP[d][0]][j + STEP[d][1]] = 1;
+        stack.push_back({i + STEP[d][0], j + STEP[d][1]});
+    }
+    for (int i = 1; i < side - 1; ++i) {
+        for (int j = 1; j < side - 1; ++j) {
+            bool between = (grid[i - 1][j] && grid[i + 1][j]) || (grid[i][j - 1] && grid[i][j + 1]);
+            if (grid[i][j] == 0 && between && random.uniform() < 0.1) grid[i][j] = 1;
+        }
+    }
+    return grid;
+}
+
+      // streets along every block-th row and column, one street between two crossings in ten closed
+vector<vector<int>> streetMap(int side, int block, FleetRandom& random) {
+    vector<vector<int>> grid(side, vector<int>(side, 0));
+    for (int i = 0; i < side; ++i) {
+        for (int j = 0; j < side; ++j) grid[i][j] = i % block == 0 || j % block == 0;
+    }
+    for (int a = 0; a < side; a += block) {
+        for (int b = 0; b + 1 < side; b += block) {
+            for (int vertical = 0; vertical < 2; ++vertical) {
+                if (random.uniform() >= 0.1) continue;
+                for (int k = b + 1; k < min(b + block, side); ++k) {
+                    if (vertical) grid[k][a] = 0;
+                    else grid[a][k] = 0;
+                }
+            }
+        }
+    }
+    return grid;
+}
+
+      // road graph of n junctions on a lattice, one road in eight missing, lengths from 10 to 99 and n / 100
+      // highways between random junctions that cost twice their lattice distance
+CSRGraph randomRoadGraph(int n, FleetRandom& random) {
+    int side = max(1, (int)ceil(sqrt((double)n)));
+    vector<Edge> edges;
+    for (int k = 0; k < n; ++k) {
+        if (k % side + 1 < side && k + 1 < n && random.uniform() >= 0.125) edges.push_back({k, k + 1, 10 + random.below(90)});
+        if (k + side < n && random.uniform() >= 0.125) edges.push_back({k, k + side, 10 + random.below(90)});
+    }
+    for (int h = 0; h < n / 100; ++h) {
+        int a = random.below(n), b = random.below(n);
+        int lattice = abs(a / side - b / side) + abs(a % side - b % side);
+        if (a != b) edges.push_back({a, b, 2 * 55 * lattice});
+    }
+    return CSRGraph::fromEdges(n, edges);
+}
+
+      // count locations in a square of the given side, uniform or around eight hotspots
+vector<Location> pointCloud(int count, double side, bool clustered, FleetRandom& random) {
+    vector<Location> hotspots(8);
+    for (Location& h : hotspots) h = {random.uniform() * side, random.uniform() * side};
+    vector<Location> cloud(count);
+    for (Location& l : cloud) {
+        if (!clustered) {
+            l = {random.uniform() * side, random.uniform() * side};
+            continue;
+        }
+        const Location& h = hotspots[random.below(hotspots.size())];
+        l = {min(side, max(0.0, h.x + random.normal() * side / 20)), min(side, max(0.0, h.y + random.normal() * side / 20))};
+    }
+    return cloud;
+}
+
+      // the same queries between random cells of the largest free area on every repeat
+BenchmarkResult benchAStar(const string& generator, const vector<vector<int>>& grid, int side, int repeats, FleetRandom& random) {
+    const int QUERIES = 8;
+    BenchmarkResult result{"astareach", generator, side};
+    vector<int> area = largestFreeArea(grid, side, side);
+    result.elements = area.size();
+    if (area.empty()) return result;
+    vector<pair<Pair, Pair>> queries;
+    for (int q = 0; q < QUERIES; ++q) {
+        int from = area[random.below(area.size())], to = area[random.below(area.size())];
+        queries.push_back({{from / side, from % side}, {to / side, to % side}});
+    }
+    ASTARSEARCHALGORITHM search(side, side);
+    result.calls = QUERIES;
+    result.samples = timeRepeats(repeats, QUERIES, [&](int repeat) {
+        for (const auto& q : queries) {
+            search.astareach(grid, q.first, q.second);
+            if (repeat == 0) result.work += search.expanded;
+        }
+    });
+    return result;
+}
+
+BenchmarkResult benchDijkstra(int n, int repeats, FleetRandom& random) {
+    const int QUERIES = 4;
+    BenchmarkResult result{"dijkstra_algo", "lattice", n};
+    CSRGraph graph = randomRoadGraph(n, random);
+    result.elements = graph.targets.size() / 2;
+    vector<pair<int, int>> queries;
+    for (int q = 0; q < QUERIES; ++q) queries.push_back({random.below(n), random.below(n)});
+    result.calls = QUERIES;
+    result.samples = timeRepeats(repeats, QUERIES, [&](int) {
+        for (const auto& q : queries) dijkstra_algo(graph, q.first, q.second);
+    });
+    ShortestPathTree tree;
+    for (const auto& q : queries) {
+        shortestPathTree(graph, q.first, tree);
+        if (tree.distance[q.second] != UNREACHABLE) result.work += tree.distance[q.second];
+    }
+    return result;
+}
+
+      // n drivers and n passengers in a square about a hundred times the spacing of the drivers
+BenchmarkResult benchHungarian(const string& generator, int n, int repeats, FleetRandom& random) {
+    BenchmarkResult result{"minimizeCost", generator, n, (long long)n * n};
+    double side = 100 * sqrt((double)n);
+    vector<Location> drivers = pointCloud(n, side, generator == "clustered", random);
+    vector<Location> passengers = pointCloud(n, side, generator == "clustered", random);
+    result.calls = 1;
+    for (int r = 0; r < repeats; ++r) {
+        HungarianAlgorithm hungarian(n, n);
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) hungarian.setCost(i, j, drivers[i].distance(passengers[j]));
+        }
+        double cost = 0;
+        result.samples.push_back(timeRepeats(1, 1, [&](int) { cost = hungarian.minimizeCost(); })[0]);
+        result.work = cost;
+    }
+    return result;
+}
+
+BenchmarkResult benchGreedy(const string& generator, int n, int repeats, FleetRandom& random) {
+    BenchmarkResult result{"rideSharingGreedy", generator, n, 2LL * n};
+    double side = 100 * sqrt((double)n);
+    vector<Location> driverCloud = pointCloud(n, side, generator == "clustered", random);
+    vector<Location> passengerCloud = pointCloud(n, side, generator == "clustered", random);
+    vector<Point> drivers(n), passengers(n);
+    for (int i = 0; i < n; ++i) {
+        drivers[i] = {i + 1, driverCloud[i].x, driverCloud[i].y};
+        passengers[i] = {i + 1, passengerCloud[i].x, passengerCloud[i].y};
+    }
+    result.calls = 1;
+    for (int r = 0; r < repeats; ++r) {
+        RideSharingProblem problem(drivers, passengers);
+        result.samples.push_back(timeRepeats(1, 1, [&](int) { rideSharingGreedy(problem); })[0]);
+        result.work = count(problem.driverAssigned.begin(), problem.driverAssigned.end(), true);
+    }
+    return result;
+}
+
+void printResult(const BenchmarkResult& result, bool csv) {
+    vector<double> sorted = result.samples;
+    sort(sorted.begin(), sorted.end());
+    double mean = 0;
+    for (double ms : sorted) mean += ms / max<size_t>(sorted.size(), 1);
+    double minMs = sorted.empty() ? 0 : sorted.front(), maxMs = sorted.empty() ? 0 : sorted.back();
+    double median = sorted.empty() ? 0 : sorted[sorted.size() / 2];
+    if (csv) {
+        cout << result.benchmark << "," << result.generator << "," << result.size << "," << result.elements << "," << result.calls
+             << "," << sorted.size() << "," << minMs << "," << median << "," << mean << "," << maxMs << "," << result.work << endl;
+        return;
+    }
+    cout << "{\"type\": \"result\", \"benchmark\": \"" << result.benchmark << "\", \"generator\": \"" << result.generator
+         << "\", \"size\": " << result.size << ", \"elements\": " << result.elements << ", \"calls\": " << result.calls
+         << ", \"repeats\": " << sorted.size() << ", \"min_ms\": " << minMs << ", \"median_ms\": " << median
+         << ", \"mean_ms\": " << mean << ", \"max_ms\": " << maxMs << ", \"work\": " << result.work << "}" << endl;
+}
+
+      // every benchmark over its size range. Each benchmark, generator and size draws its input from its own
+      // generator seeded from the seed and the size, so one of them gives the same input when run alone
+void runBenchmarks(const BenchmarkOptions& options) {
+    auto sizesOr = [&](vector<int> defaults) { return options.sizes.empty() ? defaults : options.sizes; };
+    auto wanted = [&](const string& name) { return name.find(options.only) != string::npos; };
+    auto randomFor = [&](int benchmark, int generator, int size) {
+        return FleetRandom(options.seed * 1000003 + benchmark * 7919 + generator * 104729 + size);
+    };
+    cout.precision(6);
+    if (options.csv) cout << "benchmark,generator,size,elements,calls,repeats,min_ms,median_ms,mean_ms,max_ms,work" << endl;
+    else {
+        cout << "{\"type\": \"meta\", \"seed\": " << options.seed << ", \"repeats\": " << options.repeats
+             << ", \"hardware_threads\": " << thread::hardware_concurrency() << ", \"compiler\": \"" << __VERSION__ << "\"}" << endl;
+    }
+
+    if (wanted("astareach")) {
+        for (int side : sizesOr({64, 128, 256, 512})) {
+            FleetRandom random = randomFor(0, 0, side);
+            printResult(benchAStar("random", randomMap(side, 0.7, random), side, options.repeats, random), options.csv);
+            random = randomFor(0, 1, side);
+            printResult(benchAStar("maze", mazeMap(side, random), side, options.repeats, random), options.csv);
+            random = randomFor(0, 2, side);
+            printResult(benchAStar("streets", streetMap(side, 8, random), side, options.repeats, random), options.csv);
+        }
+    }
+    if (wanted("dijkstra_algo")) {
+        for (int n : sizesOr({1000, 10000, 100000, 1000000})) {
+            FleetRandom random = randomFor(1, 0, n);
+            printResult(benchDijkstra(n, options.repeats, random), options.csv);
+        }
+    }
+    if (wanted("minimizeCost")) {
+        for (int n : sizesOr({64, 128, 256, 512, 1024})) {
+            FleetRandom random = randomFor(2, 0, n);
+            printResult(benchHungarian("uniform", n, options.repeats, random), options.csv);
+            random = randomFor(2, 1, n);
+            printResult(benchHungarian("clustered", n, options.repeats, random), options.csv);
+        }
+    }
+    if (wanted("rideSharingGreedy")) {
+        for (int n : sizesOr({1000, 10000, 100000})) {
+            FleetRandom random = randomFor(3, 0, n);
+            printResult(benchGreedy("uniform", n, options.repeats, random), options.csv);
+            random = randomFor(3, 1, n);
+            printResult(benchGreedy("clustered", n, options.repeats, random), options.csv);
+        }
+    }
+}
+
+  // pass --only NAME to run only the benchmarks whose name contains NAME (astareach, dijkstra_algo,
+  // minimizeCost, rideSharingGreedy), --sizes A,B,C to use those sizes for every benchmark run,
+  // --repeats R for the timed runs of each (default 3), --seed S to generate other inputs and --csv for CSV
+  // instead of JSON lines
+int main(int argc, char** argv) {
+    BenchmarkOptions options;
+    for (int a = 1; a < argc; a++) {
+        if (string(argv[a]) == "--only" && a + 1 < argc) options.only = argv[++a];
+        else if (string(argv[a]) == "--repeats" && a + 1 < argc) options.repeats = max(1, atoi(argv[++a]));
+        else if (string(argv[a]) == "--seed" && a + 1 < argc) options.seed = strtoull(argv[++a], nullptr, 10);
+        else if (string(argv[a]) == "--csv") options.csv = true;
+        else if (string(argv[a]) == "--sizes" && a + 1 < argc) {
+            string list = argv[++a];
+            for (size_t start = 0; start <= list.size();) {
+                size_t end = list.find(',', start);
+                if (end == string::npos) end = list.size();
+                int size = atoi(list.substr(start, end - start).c_str());
+                if (size > 0) options.sizes.push_back(size);
+                start = end + 1;
+            }
+        }
+    }
+    runBenchmarks(options);
+    return 0;
+}
@@ -4,17 +4,34 @@
 #include <queue>
 #include <cmath>
 #include <algorithm>
+#include <string>
+#include <cstring>
+#include <chrono>
+
+// other programs include this file with OPTIRIDE_NO_MAIN defined to use the matchers, its main is then left out
+#ifndef OPTIRIDE_NO_MAIN
+#define OPTIRIDE_NO_MAIN
+#define OPTIRIDE_HUNGARIAN_MAIN
+#endif
+// road graph, contraction hierarchy and many to many distance tables
+#include "dIjkstra_algo"
+// greedy nearest driver matcher
+#include "Greedy_Algo.cpp"
+// grid map searches the fleet simulation routes its drivers with
+#include "A_STAR_SEARCH_ALGORITHM.cpp"
 
 using namespace std;
 
 // constants
-const int INF = numeric_limits<int>::max();
 const int MAX_DRIVERS = 100;
 const int MAX_PASSENGERS = 100;
+// cost of a pair that must not be matched, such as one the road network cannot connect
+const double UNASSIGNABLE = numeric_limits<double>::infinity();
 
 // structure for Location
 struct Location {
     double x, y;
+    int node = -1; // road graph node, -1 if only the coordinates are known
     
     double distance(const Location& other) const {
         return sqrt((x - other.x) * (x - other.x) + (y - other.y) * (y - other.y));
@@ -36,93 +53,799 @@ struct Passenger {
     bool assigned;
 };
 
-   // hungarian Algorithm for assignment
+   // hungarian Algorithm for assignment of drivers to passengers, either side may be larger.
+   // the problem is kept square: rows past the drivers and columns past the passengers are dummies, and
+   // a driver or passenger matched to a dummy is left without a match. Unassignable pairs cost a penalty
+   // higher than any matching of real pairs and a driver or passenger left alone half of it, so as many
+   // pairs as possible are matched. Two dummies cost 0.
+   // the costs are one row-major block with each row padded to a whole number of vector lanes
+   // so the scan over a row is a straight SIMD pass.
+   // the potentials and the matching are kept between calls: after drivers or passengers join, leave
+   // or get new costs only the rows they touch are matched again, with the same optimal cost
 class HungarianAlgorithm {
 private:
-    int n;                 // number of drivers/passengers
-    vector<vector<double>> costMatrix;
+#ifdef __AVX__
+    static const int LANES = 4;
+#else
+    static const int LANES = 2;
+#endif
+    int drivers = 0, passengers = 0; // slots handed out, the slots of removed ones are reused
+    int size = 0;                    // side of the square problem, the larger of the two
+    int stride = 0;                  // room for columns, a multiple of LANES, columns past size are UNASSIGNABLE
+    vector<double> costMatrix;       // size rows of stride costs
+    vector<bool> driverActive, passengerActive;
+    vector<int> freeDrivers, freePassengers;
+    double penalty = 0;              // cost of an unassignable pair inside the square
+    double low = 0, high = 0;        // range of the costs the penalty was set for
+
+      // potentials and matching, kept between calls. rowOf[j] is the row matched to column j, colOf[i] the column of row i
+    vector<double> u, v;
+    vector<int> rowOf, colOf;
+    bool warm = false;
+      // what changed since the last call
+    vector<int> dirtyRows, dirtyCols;
+    vector<bool> rowDirty, colDirty;
+    vector<pair<int, int>> changed;
     vector<int> assigned;
 
+    double& at(int i, int j) {
+        return costMatrix[(size_t)i * stride + j];
+    }
+
+      // cost of a pair without a cost of its own: the penalty for a driver and a passenger, half of it
+      // for one of them with a dummy. Until the first solve sets the penalty it is UNASSIGNABLE and 0
+    double defaultCost(int i, int j) const {
+        int real = driverActive[i] + passengerActive[j];
+        if (!warm) return real == 2 ? UNASSIGNABLE : 0;
+        return real * penalty / 2;
+    }
+
+      // smallest penalty whose half still outweighs the cost difference of any two matchings
+    double penaltyNeeded() const {
+        return 2 * ((high - low + 1) * (size + 1) + fabs(high) + fabs(low));
+    }
+
+    void markRow(int i) {
+        if (!warm || rowDirty[i]) return;
+        rowDirty[i] = true;
+        dirtyRows.push_back(i);
+    }
+
+    void markCol(int j) {
+        if (!warm || colDirty[j]) return;
+        colDirty[j] = true;
+        dirtyCols.push_back(j);
+    }
+
+      // grow the square to newSize, the new rows and columns are dummies
+    void grow(int newSize) {
+        if (newSize <= size) return;
+        if (newSize > stride) {
+            int newStride = max((newSize + LANES - 1) / LANES * LANES, stride * 2);
+            vector<double> moved((size_t)size * newStride, UNASSIGNABLE);
+            for (int i = 0; i < size; ++i) {
+                copy(&at(i, 0), &at(i, 0) + size, &moved[(size_t)i * newStride]);
+            }
+            costMatrix.swap(moved);
+            stride = newStride;
+            v.resize(stride, 0);
+            rowOf.resize(stride, -1);
+            colDirty.resize(stride, false);
+        }
+        costMatrix.resize((size_t)newSize * stride, UNASSIGNABLE);
+        u.resize(newSize, 0);
+        colOf.resize(newSize, -1);
+        rowDirty.resize(newSize, false);
+        driverActive.resize(newSize, false);
+        passengerActive.resize(newSize, false);
+        int oldSize = size;
+        size = newSize;
+        for (int i = 0; i < newSize; ++i) {
+            for (int j = i < oldSize ? oldSize : 0; j < newSize; ++j) at(i, j) = defaultCost(i, j);
+        }
+        for (int k = oldSize; k < newSize; ++k) {
+            markRow(k);
+            markCol(k);
+        }
+        if (warm && penaltyNeeded() > penalty) invalidate();
+    }
+
+      // forget the potentials, the next call solves from scratch
+    void invalidate() {
+        if (warm) {
+            for (int i = 0; i < size; ++i) {
+                for (int j = 0; j < size; ++j) {
+                    if (driverActive[i] && passengerActive[j] && at(i, j) == penalty) at(i, j) = UNASSIGNABLE;
+                }
+            }
+        }
+        warm = false;
+        for (int i : dirtyRows) rowDirty[i] = false;
+        for (int j : dirtyCols) colDirty[j] = false;
+        dirtyRows.clear();
+        dirtyCols.clear();
+        changed.clear();
+    }
+
+      // shortest augmenting path from free row i to a free column, lengths are reduced costs so
+      // they never go negative, and the potentials move so every edge on the tree is tight again
+    void augment(int i) {
+        typedef double Lanes __attribute__((vector_size(LANES * sizeof(double))));
+        typedef long long Indices __attribute__((vector_size(LANES * sizeof(long long))));
+        int width = (size + LANES - 1) / LANES * LANES;
+          // length of the shortest alternating path from row i to every column, and the row it comes from
+        vector<double> pathCost(width, UNASSIGNABLE);
+        vector<long long> pathRow(width);
+          // 0 for columns still open, UNASSIGNABLE once a column is on the search tree
+        vector<double> closed(width, 0.0);
+          // 0 for free columns, UNASSIGNABLE for matched ones: among equally short paths one that ends
+          // at a free column is taken, which keeps dummies with all their costs equal from chaining
+        vector<double> taken(width, UNASSIGNABLE);
+        for (int j = 0; j < size; ++j) {
+            if (rowOf[j] == -1) taken[j] = 0;
+        }
+        vector<int> treeRows(1, i), treeCols;
+        double reached = 0; // length of the paths to the columns already on the tree
+        int i0 = i, sink = -1;
+        while (sink == -1) {
+              // one pass over row i0: shorten the paths through it and find the shortest path
+              // to an open column, lane by lane, ties going to the lowest column
+            const double* row = &at(i0, 0);
+            const Lanes base = Lanes{} + (reached - u[i0]);
+            const Indices from = Indices{} + i0;
+            Lanes best = Lanes{} + UNASSIGNABLE, bestFree = best;
+            Indices bestIndex = Indices{} - 1, bestFreeIndex = bestIndex;
+            Indices index;
+            for (int l = 0; l < LANES; l++) index[l] = l;
+            for (int j = 0; j < width; j += LANES, index += LANES) {
+                Lanes c, vj, length, shut, busy;
+                Indices through;
+                memcpy(&c, row + j, sizeof(c));
+                memcpy(&busy, &taken[j], sizeof(busy));
+                memcpy(&vj, &v[j], sizeof(vj));
+                memcpy(&length, &pathCost[j], sizeof(length));
+                memcpy(&shut, &closed[j], sizeof(shut));
+                memcpy(&through, &pathRow[j], sizeof(through));
+                c = base + c - vj;
+                Indices shorter = c + shut < length;
+                length = shorter ? c : length;
+                through = shorter ? from : through;
+                memcpy(&pathCost[j], &length, sizeof(length));
+                memcpy(&pathRow[j], &through, sizeof(through));
+                Lanes open = length + shut;
+                Indices better = open < best;
+                best = better ? open : best;
+                bestIndex = better ? index : bestIndex;
+                Lanes openFree = open + busy;
+                better = openFree < bestFree;
+                bestFree = better ? openFree : bestFree;
+                bestFreeIndex = better ? index : bestFreeIndex;
+            }
+            double shortest = UNASSIGNABLE, shortestFree = UNASSIGNABLE;
+            long long j1 = -1, free1 = -1;
+            for (int l = 0; l < LANES; l++) {
+                if (best[l] < shortest || (best[l] == shortest && bestIndex[l] < j1)) {
+                    shortest = best[l];
+                    j1 = bestIndex[l];
+                }
+                if (bestFree[l] < shortestFree || (bestFree[l] == shortestFree && bestFreeIndex[l] < free1)) {
+                    shortestFree = bestFree[l];
+                    free1 = bestFreeIndex[l];
+                }
+            }
+            if (free1 != -1 && shortestFree == shortest) j1 = free1;
+              // every cost in the square is finite, so some open column is always reachable
+            if (j1 == -1) return;
+
+            reached = shortest;
+            closed[j1] = UNASSIGNABLE;
+            treeCols.push_back((int)j1);
+            if (rowOf[j1] == -1) {
+                sink = (int)j1;
+            } else {
+                i0 = rowOf[j1];
+                treeRows.push_back(i0);
+            }
+        }
+
+        u[i] += reached;
+        for (size_t k = 1; k < treeRows.size(); ++k) {
+            u[treeRows[k]] += reached - pathCost[colOf[treeRows[k]]];
+        }
+        for (int j : treeCols) {
+            v[j] -= reached - pathCost[j];
+        }
+          // augmenting path
+        for (int j = sink;;) {
+            int r = (int)pathRow[j];
+            rowOf[j] = r;
+            swap(colOf[r], j);
+            if (r == i) break;
+        }
+    }
+
+      // give row i the potential of its cheapest column, and that column if it is free
+    void reduceRow(int i) {
+        const double* row = &at(i, 0);
+        double best = UNASSIGNABLE;
+        int cheapest = -1;
+        for (int j = 0; j < size; ++j) {
+            if (row[j] - v[j] < best) {
+                best = row[j] - v[j];
+                cheapest = j;
+            }
+        }
+        u[i] = best;
+        if (rowOf[cheapest] == -1) {
+            rowOf[cheapest] = i;
+            colOf[i] = cheapest;
+        }
+    }
+
+      // solve from scratch: the penalty is set for the current costs, and every row starts from
+      // reduced costs with as many rows as possible matched before any shortest path search
+    void coldStart() {
+        low = high = 0;
+        for (int i = 0; i < size; ++i) {
+            for (int j = 0; j < size; ++j) {
+                double cost = at(i, j);
+                if (!driverActive[i] || !passengerActive[j] || cost == UNASSIGNABLE) continue;
+                low = min(low, cost);
+                high = max(high, cost);
+            }
+        }
+          // with room to spare, so costs a little out of range or a few more drivers do not force another cold start
+        penalty = 4 * penaltyNeeded();
+        warm = true;
+        for (int i = 0; i < size; ++i) {
+            for (int j = 0; j < size; ++j) {
+                if (!driverActive[i] || !passengerActive[j] || at(i, j) == UNASSIGNABLE) at(i, j) = defaultCost(i, j);
+            }
+        }
+
+        u.assign(size, 0);
+        v.assign(stride, 0);
+        rowOf.assign(stride, -1);
+        colOf.assign(size, -1);
+
+          // with dummies on one side the reductions below leave the free columns at uneven potentials,
+          // and every dummy row, costing the same everywhere, then has a long search to reach one. Instead
+          // the drivers are matched first from row minima with every column at 0, which keeps the free
+          // columns at 0, and each row after them finds a free column among its cheapest right away
+        int activeDrivers = 0, activePassengers = 0;
+        for (int k = 0; k < size; ++k) {
+            activeDrivers += driverActive[k];
+            activePassengers += passengerActive[k];
+        }
+        if (min(activeDrivers, activePassengers) < size) {
+            for (int i = 0; i < size; ++i) {
+                const double* row = &at(i, 0);
+                u[i] = *min_element(row, row + size);
+            }
+            for (int i = 0; i < size; ++i) {
+                if (driverActive[i]) augment(i);
+            }
+            for (int i = 0; i < size; ++i) {
+                if (!driverActive[i]) augment(i);
+            }
+            return;
+        }
+
+          // every column drops to its cheapest row, then every row to its cheapest column
+        fill(v.begin(), v.begin() + size, UNASSIGNABLE);
+        for (int i = 0; i < size; ++i) {
+            const double* row = &at(i, 0);
+            for (int j = 0; j < size; ++j) v[j] = min(v[j], row[j]);
+        }
+        for (int i = 0; i < size; ++i) reduceRow(i);
+
+          // augmenting row reduction as in Jonker and Volgenant: a free row takes its cheapest column and
+          // lowers that column's potential until its second cheapest is as good, so the row it pushes
+          // out has to look elsewhere. Every matched row keeps its cheapest column, and most rows
+          // end up matched without a shortest path search
+        vector<int> freeRows, stillFree;
+        for (int i = 0; i < size; ++i) {
+            if (colOf[i] == -1) freeRows.push_back(i);
+        }
+        for (int pass = 0; pass < 2; ++pass) {
+            stillFree.clear();
+              // a row pushed out by an actual drop in potential is retried at once, bounded so ties cannot cycle
+            size_t retries = 0, limit = (size_t)size * 4;
+            for (size_t k = 0; k < freeRows.size(); ++k) {
+                int i = freeRows[k];
+                const double* row = &at(i, 0);
+                double first = UNASSIGNABLE, second = UNASSIGNABLE;
+                int j1 = -1, j2 = -1;
+                for (int j = 0; j < size; ++j) {
+                    double h = row[j] - v[j];
+                    if (h < second) {
+                        if (h >= first) {
+                            second = h;
+                            j2 = j;
+                        } else {
+                            second = first;
+                            j2 = j1;
+                            first = h;
+                            j1 = j;
+                        }
+                    }
+                }
+                if (j2 == -1) {
+                    stillFree.push_back(i);
+                    continue;
+                }
+                int pushed = rowOf[j1];
+                bool lowered = first < second;
+                if (lowered) {
+                    v[j1] -= second - first;
+                } else if (pushed != -1) {
+                    j1 = j2;
+                    pushed = rowOf[j2];
+                }
+                rowOf[j1] = i;
+                colOf[i] = j1;
+                if (pushed != -1) {
+                    colOf[pushed] = -1;
+                    if (lowered && retries++ < limit) freeRows[k--] = pushed;
+                    else stillFree.push_back(pushed);
+                }
+            }
+            freeRows.swap(stillFree);
+        }
+        for (int i = 0; i < size; ++i) {
+            const double* row = &at(i, 0);
+            if (colOf[i] != -1) {
+                u[i] = row[colOf[i]] - v[colOf[i]];
+                continue;
+            }
+            u[i] = UNASSIGNABLE;
+            for (int j = 0; j < size; ++j) u[i] = min(u[i], row[j] - v[j]);
+        }
+
+        for (int i = 0; i < size; ++i) {
+            if (colOf[i] == -1) augment(i);
+        }
+    }
+
+      // re-match after changes: a changed column drops its match and takes the potential of its cheapest
+      // row, a row that changed or lost its column takes the potential of its cheapest column, which keeps
+      // every reduced cost non-negative, and the rows left free are augmented
+    void repair() {
+        for (int j : dirtyCols) {
+            if (rowOf[j] != -1) {
+                int r = rowOf[j];
+                colOf[r] = -1;
+                rowOf[j] = -1;
+                markRow(r);
+            }
+            double best = UNASSIGNABLE;
+            for (int i = 0; i < size; ++i) best = min(best, at(i, j) - u[i]);
+            v[j] = best;
+        }
+        for (const pair<int, int>& cell : changed) {
+            int i = cell.first, j = cell.second;
+            if (rowDirty[i] || colDirty[j]) continue;
+              // a cheaper pair than the potentials allow, or a matched pair whose cost moved
+            if (rowOf[j] == i || at(i, j) - u[i] - v[j] < 0) markRow(i);
+        }
+        for (int i : dirtyRows) {
+            if (colOf[i] != -1) {
+                rowOf[colOf[i]] = -1;
+                colOf[i] = -1;
+            }
+        }
+        for (int i : dirtyRows) reduceRow(i);
+        for (int i : dirtyRows) {
+            if (colOf[i] == -1) augment(i);
+        }
+        for (int i = 0; i < size; ++i) {
+            if (colOf[i] == -1) augment(i);
+        }
+        for (int i : dirtyRows) rowDirty[i] = false;
+        for (int j : dirtyCols) colDirty[j] = false;
+        dirtyRows.clear();
+        dirtyCols.clear();
+        changed.clear();
+    }
+
 public:
-    HungarianAlgorithm(int n) : n(n), costMatrix(n, vector<double>(n, INF)), assigned(n, -1) {}
+    HungarianAlgorithm(int rows, int cols) {
+        for (int i = 0; i < rows; ++i) addDriver();
+        for (int j = 0; j < cols; ++j) addPassenger();
+    }
+
+      // a new driver, unassignable to every passenger until its costs are set. Returns its index
+    int addDriver() {
+        int i;
+        if (!freeDrivers.empty()) {
+            i = freeDrivers.back();
+            freeDrivers.pop_back();
+        } else {
+            i = drivers++;
+            grow(drivers);
+        }
+        driverActive[i] = true;
+        for (int j = 0; j < size; ++j) at(i, j) = defaultCost(i, j);
+        markRow(i);
+        return i;
+    }
+
+      // a new passenger, unassignable to every driver until its costs are set. Returns its index
+    int addPassenger() {
+        int j;
+        if (!freePassengers.empty()) {
+            j = freePassengers.back();
+            freePassengers.pop_back();
+        } else {
+            j = passengers++;
+            grow(passengers);
+        }
+        passengerActive[j] = true;
+        for (int i = 0; i < size; ++i) at(i, j) = defaultCost(i, j);
+        markCol(j);
+        return j;
+    }
+
+      // the driver leaves, its index may be handed out again by addDriver
+    void removeDriver(int driverIndex) {
+        if (!driverActive[driverIndex]) return;
+        driverActive[driverIndex] = false;
+        freeDrivers.push_back(driverIndex);
+        for (int j = 0; j < size; ++j) at(driverIndex, j) = defaultCost(driverIndex, j);
+        markRow(driverIndex);
+    }
+
+      // the passenger leaves, its index may be handed out again by addPassenger
+    void removePassenger(int passengerIndex) {
+        if (!passengerActive[passengerIndex]) return;
+        passengerActive[passengerIndex] = false;
+        freePassengers.push_back(passengerIndex);
+        for (int i = 0; i < size; ++i) at(i, passengerIndex) = defaultCost(i, passengerIndex);
+        markCol(passengerIndex);
+    }
 
     void setCost(int driverIndex, int passengerIndex, double cost) {
-        costMatrix[driverIndex][passengerIndex] = cost;
+        if (!driverActive[driverIndex] || !passengerActive[passengerIndex]) return;
+        if (cost == UNASSIGNABLE) {
+            cost = defaultCost(driverIndex, passengerIndex);
+        } else if (warm && (cost < low || cost > high)) {
+            low = min(low, cost);
+            high = max(high, cost);
+              // the penalty no longer outweighs the real costs, start over
+            if (penaltyNeeded() > penalty) invalidate();
+        }
+        at(driverIndex, passengerIndex) = cost;
+        if (warm) changed.push_back({driverIndex, passengerIndex});
+    }
+
+      // the pair is never matched, whatever it would cost
+    void setUnassignable(int driverIndex, int passengerIndex) {
+        setCost(driverIndex, passengerIndex, UNASSIGNABLE);
     }
 
+      // matches as many drivers as the assignable pairs allow, at the lowest total cost, and returns that cost.
+      // the first call solves from scratch, later ones only repair what changed since the call before
     double minimizeCost() {
-           // vectors for labeling
-        vector<double> u(n, 0), v(n, 0);
-        vector<int> p(n, -1), way(n, -1);
-        vector<double> minv(n);
-        vector<bool> used(n);
+        if (warm) repair();
+        else coldStart();
 
-          // main hungarian algorithm loop
-        for (int i = 0; i < n; ++i) {
-            fill(minv.begin(), minv.end(), INF);
-            fill(used.begin(), used.end(), false);
-            int j0 = 0;
-            p[0] = i;
-            do {
-                used[j0] = true;
-                int i0 = p[j0], j1 = -1;
-                double delta = INF;
-                for (int j = 1; j < n; ++j) {
-                    if (!used[j]) {
-                        double cur = costMatrix[i0][j] - u[i0] - v[j];
-                        if (cur < minv[j]) {
-                            minv[j] = cur;
-                            way[j] = j0;
-                        }
-                        if (minv[j] < delta) {
-                            delta = minv[j];
-                            j1 = j;
-                        }
+        assigned.assign(drivers, -1);
+        double total = 0;
+        for (int i = 0; i < drivers; ++i) {
+            int j = colOf[i];
+            if (!driverActive[i] || j >= passengers || !passengerActive[j] || at(i, j) == penalty) continue;
+            assigned[i] = j;
+            total += at(i, j);
+        }
+        return total;
+    }
+
+      // passenger index of every driver, -1 for drivers left without one
+    vector<int> getAssigned() {
+        return assigned;
+    }
+};
+
+   // auction Algorithm for assignment on a sparse candidate graph, such as every passenger's k nearest drivers.
+   // passengers bid for drivers: each one takes the driver with the lowest cost plus price and raises
+   // that price by how much better it is than the next choice plus epsilon. A passenger may also stay
+   // unmatched at a fixed cost, so bidding always ends even when the candidates run out.
+   // epsilon starts large and shrinks between rounds of bidding that keep the prices, the matching
+   // ends within (drivers + passengers) x epsilon of optimal and the actual gap is measured from the prices.
+   // every unmatched passenger bids at once on its own thread slice, the highest bid on a driver wins
+   // through an atomic max and the lowest passenger index breaks ties, so the result does not depend
+   // on the number of threads
+class AuctionAlgorithm {
+private:
+    int drivers, passengers;
+    struct Candidate {
+        int passenger, driver;
+        double cost;
+    };
+    vector<Candidate> candidates;
+      // objects grouped by bidder: the objects of bidder i are objectOf[first[i]] .. objectOf[first[i + 1] - 1]
+    vector<int> first, objectOf;
+    vector<double> costOf;
+    vector<int> assigned; // passenger of every driver, -1 if none
+    double gap = 0;
+
+public:
+    AuctionAlgorithm(int drivers, int passengers) : drivers(drivers), passengers(passengers), assigned(drivers, -1) {}
+
+      // the driver may be matched to the passenger at this cost, pairs never added are never matched
+    void addCandidate(int driverIndex, int passengerIndex, double cost) {
+        candidates.push_back({passengerIndex, driverIndex, cost});
+    }
+
+      // matches at a cost at most finalEpsilon x (drivers + passengers) above the optimum, as many passengers as the
+      // candidates allow. A finalEpsilon of 0 takes 1 / (drivers + passengers + 1), exact when the costs are integers.
+      // Returns the total cost
+    double minimizeCost(double finalEpsilon = 0, int threads = 0) {
+        if (threads <= 0) threads = max(1u, thread::hardware_concurrency());
+        int n = drivers + passengers;
+        if (finalEpsilon <= 0) finalEpsilon = 1.0 / (n + 1);
+
+        double low = 0, high = 0;
+        for (const Candidate& c : candidates) {
+            low = min(low, c.cost);
+            high = max(high, c.cost);
+        }
+          // staying unmatched costs more than any difference in real costs, so as many passengers as possible are matched
+        double unmatched = (high - low + 1) * (passengers + 1) + fabs(high) + fabs(low);
+
+          // made square so that every bidder ends up with an object and the prices stay tight: bidder i < passengers
+          // is a passenger, bidder passengers + j stands for driver j staying idle. Object j < drivers is a driver,
+          // object drivers + i is passenger i left unmatched. A passenger takes a driver or its own unmatched object,
+          // the idle bidder of a driver takes the driver itself or the unmatched object of any of its candidates,
+          // which frees up exactly when that passenger takes the driver
+        first.assign(n + 1, 0);
+        for (const Candidate& c : candidates) {
+            first[c.passenger + 1]++;
+            first[passengers + c.driver + 1]++;
+        }
+        for (int k = 0; k < n; ++k) first[k + 1] += first[k] + 1;
+        objectOf.resize(first[n]);
+        costOf.resize(first[n]);
+        vector<int> next(first.begin(), first.end() - 1);
+        auto link = [&](int bidder, int object, double cost) {
+            objectOf[next[bidder]] = object;
+            costOf[next[bidder]++] = cost;
+        };
+        for (int i = 0; i < passengers; ++i) link(i, drivers + i, unmatched);
+        for (int j = 0; j < drivers; ++j) link(passengers + j, j, 0);
+        for (const Candidate& c : candidates) {
+            link(c.passenger, c.driver, c.cost);
+            link(passengers + c.driver, drivers + c.passenger, 0);
+        }
+
+        vector<double> price(n, 0);
+        vector<int> owner(n, -1);    // bidder holding each object
+        vector<int> holding(n, -1);  // object each bidder holds, -1 while bidding
+        unique_ptr<atomic<double>[]> bestBid(new atomic<double>[n]);
+        unique_ptr<atomic<int>[]> winner(new atomic<int>[n]);
+        for (int k = 0; k < n; ++k) {
+            bestBid[k].store(-UNASSIGNABLE, memory_order_relaxed);
+            winner[k].store(n, memory_order_relaxed);
+        }
+        vector<int> bidTarget(n);
+        vector<double> bidPrice(n);
+        vector<vector<int>> touched(threads), nextBidders(threads);
+        vector<int> bidders, contested;
+
+        double epsilon = max(finalEpsilon, unmatched / 5);
+        int phase = 0; // 0 bidding, 1 choosing winners, 2 handing objects over
+        bool done = false;
+        atomic<size_t> cursor{0};
+        SpinBarrier barrier(threads);
+        const size_t CHUNK = 256, SERIAL = 1024;
+
+          // a new epsilon: prices stay, every bidder bids again
+          // best and second best cost plus price, a bidder with a single object raises it by epsilon
+        auto bid = [&](int i) {
+            double best = UNASSIGNABLE, second = UNASSIGNABLE;
+            int target = -1;
+            for (int e = first[i]; e < first[i + 1]; ++e) {
+                double value = costOf[e] + price[objectOf[e]];
+                if (value < best) {
+                    second = best;
+                    best = value;
+                    target = objectOf[e];
+                } else if (value < second) {
+                    second = value;
+                }
+            }
+            if (second == UNASSIGNABLE) second = best;
+            bidTarget[i] = target;
+            bidPrice[i] = price[target] + (second - best) + epsilon;
+        };
+
+        auto startRound = [&]() {
+            fill(owner.begin(), owner.end(), -1);
+            fill(holding.begin(), holding.end(), -1);
+            bidders.resize(n);
+            for (int k = 0; k < n; ++k) bidders[k] = k;
+        };
+        startRound();
+
+          // run by thread 0 between phases while the others wait at the barrier
+        auto coordinate = [&]() {
+            cursor.store(0, memory_order_relaxed);
+            if (phase == 0) {
+                phase = 1;
+                return;
+            }
+            if (phase == 1) {
+                contested.clear();
+                for (vector<int>& list : touched) {
+                    contested.insert(contested.end(), list.begin(), list.end());
+                    list.clear();
+                }
+                phase = 2;
+                return;
+            }
+            bidders.clear();
+            for (vector<int>& list : nextBidders) {
+                bidders.insert(bidders.end(), list.begin(), list.end());
+                list.clear();
+            }
+            phase = 0;
+              // the last few bidders of a round tend to displace each other one at a time, which is cheaper
+              // done in turn, in passenger order so the outcome stays the same for any number of threads
+            if (bidders.size() <= SERIAL) {
+                sort(bidders.begin(), bidders.end());
+                for (size_t k = 0; k < bidders.size(); ++k) {
+                    int i = bidders[k];
+                    bid(i);
+                    int j = bidTarget[i];
+                    if (owner[j] != -1) {
+                        holding[owner[j]] = -1;
+                        bidders.push_back(owner[j]);
                     }
+                    owner[j] = i;
+                    holding[i] = j;
+                    price[j] = bidPrice[i];
                 }
-                for (int j = 0; j < n; ++j) {
-                    if (used[j]) {
-                        u[p[j]] += delta;
-                        v[j] -= delta;
-                    } else {
-                        minv[j] -= delta;
+                bidders.clear();
+            }
+            if (!bidders.empty()) return;
+            if (epsilon <= finalEpsilon) {
+                done = true;
+                return;
+            }
+            epsilon = max(finalEpsilon, epsilon / 5);
+            startRound();
+        };
+
+        auto worker = [&](int t) {
+            while (true) {
+                barrier.wait();
+                if (done) break;
+                const vector<int>& work = phase == 2 ? contested : bidders;
+                for (size_t begin; (begin = cursor.fetch_add(CHUNK, memory_order_relaxed)) < work.size();) {
+                    size_t end = min(work.size(), begin + CHUNK);
+                    for (size_t k = begin; k < end; ++k) {
+                        if (phase == 0) {
+                            int i = work[k], target;
+                            bid(i);
+                            target = bidTarget[i];
+                            double seen = bestBid[target].load(memory_order_relaxed);
+                            while (bidPrice[i] > seen && !bestBid[target].compare_exchange_weak(seen, bidPrice[i], memory_order_relaxed)) {}
+                        } else if (phase == 1) {
+                              // the highest bid takes the object, the lowest bidder among equal bids
+                            int i = work[k], target = bidTarget[i];
+                            if (bidPrice[i] != bestBid[target].load(memory_order_relaxed)) {
+                                nextBidders[t].push_back(i);
+                                continue;
+                            }
+                            int seen = winner[target].load(memory_order_relaxed);
+                            while (true) {
+                                if (seen < i) {
+                                    nextBidders[t].push_back(i);
+                                    break;
+                                }
+                                if (winner[target].compare_exchange_weak(seen, i, memory_order_relaxed)) {
+                                      // the first bid to land lists the object, a later lower one sends the one it replaced back
+                                    if (seen == n) touched[t].push_back(target);
+                                    else nextBidders[t].push_back(seen);
+                                    break;
+                                }
+                            }
+                        } else {
+                              // hand the object to the winner, its old holder bids again
+                            int j = work[k], w = winner[j].load(memory_order_relaxed);
+                            if (owner[j] != -1) {
+                                holding[owner[j]] = -1;
+                                nextBidders[t].push_back(owner[j]);
+                            }
+                            owner[j] = w;
+                            holding[w] = j;
+                            price[j] = bestBid[j].load(memory_order_relaxed);
+                            bestBid[j].store(-UNASSIGNABLE, memory_order_relaxed);
+                            winner[j].store(n, memory_order_relaxed);
+                        }
                     }
                 }
-                j0 = j1;
-            } while (p[j0] != -1);
-            
-                  // augmenting path
-            do {
-                int j1 = way[j0];
-                p[j0] = p[j1];
-                j0 = j1;
-            } while (j0);
-        }
+                barrier.wait();
+                if (t == 0) coordinate();
+            }
+        };
 
-        assigned = vector<int>(n);
-        for (int j = 0; j < n; ++j) {
-            assigned[p[j]] = j;
+        vector<thread> pool;
+        for (int t = 1; t < threads; ++t) pool.emplace_back(worker, t);
+        worker(0);
+        for (thread& th : pool) th.join();
+
+          // the prices give a lower bound on the optimum: every bidder pays at least its cheapest cost plus price,
+          // less what the objects are paid. Every object is held, so the gap to it adds up what each bidder pays
+          // above its cheapest, which stays exact where the two large sums would not
+        double matchedCost = 0;
+        gap = 0;
+        assigned.assign(drivers, -1);
+        for (int i = 0; i < n; ++i) {
+            double cheapest = UNASSIGNABLE, paid = 0;
+            for (int e = first[i]; e < first[i + 1]; ++e) {
+                double value = costOf[e] + price[objectOf[e]];
+                cheapest = min(cheapest, value);
+                if (objectOf[e] != holding[i]) continue;
+                paid = value;
+                if (i < passengers && holding[i] < drivers) {
+                    assigned[holding[i]] = i;
+                    matchedCost += costOf[e];
+                }
+            }
+            gap += paid - cheapest;
         }
-        return -v[0];
+        return matchedCost;
     }
 
+      // how far above the optimum the last matching can be at most, taken from the prices
+    double getGap() {
+        return gap;
+    }
+
+      // passenger index of every driver, -1 for drivers left without one
     vector<int> getAssigned() {
         return assigned;
     }
 };
 
+      // function to fill the cost matrix with road distances, one many to many table for all pairs
+      // pairs the roads cannot connect are unassignable
+void setRoadCosts(HungarianAlgorithm& hungarian, CHManyToMany& roads, const vector<Driver>& drivers, const vector<Passenger>& passengers) {
+    vector<int> sources(drivers.size()), targets(passengers.size());
+    for (size_t i = 0; i < drivers.size(); ++i) {
+        sources[i] = drivers[i].location.node;
+    }
+    for (size_t j = 0; j < passengers.size(); ++j) {
+        targets[j] = passengers[j].location.node;
+    }
+    vector<vector<long long>> table;
+    roads.table(sources, targets, table);
+    for (size_t i = 0; i < drivers.size(); ++i) {
+        for (size_t j = 0; j < passengers.size(); ++j) {
+            if (table[i][j] == UNREACHABLE) hungarian.setUnassignable(i, j);
+            else hungarian.setCost(i, j, (double)table[i][j]);
+        }
+    }
+}
+
       // function to assign drivers to passengers
-void assignDrivers(vector<Driver>& drivers, vector<Passenger>& passengers) {
-    int n = min(drivers.size(), passengers.size());
+      // with roads the cost is the road distance between their nodes, otherwise the straight line distance
+void assignDrivers(vector<Driver>& drivers, vector<Passenger>& passengers, CHManyToMany* roads = nullptr) {
+    int rows = drivers.size(), cols = passengers.size();
 
-      // initialize hungarian algorithm for matching
-    HungarianAlgorithm hungarian(n);
+      // initialize hungarian algorithm for matching, everyone takes part even when the counts differ
+    HungarianAlgorithm hungarian(rows, cols);
 
       // set up the cost matrix (distance-based)
-    for (int i = 0; i < n; ++i) {
-        for (int j = 0; j < n; ++j) {
-            double dist = drivers[i].location.distance(passengers[j].location);
-            hungarian.setCost(i, j, dist);
+    if (roads) {
+        setRoadCosts(hungarian, *roads, drivers, passengers);
+    } else {
+        for (int i = 0; i < rows; ++i) {
+            for (int j = 0; j < cols; ++j) {
+                double dist = drivers[i].location.distance(passengers[j].location);
+                hungarian.setCost(i, j, dist);
+            }
         }
     }
 
@@ -131,14 +854,1504 @@ void assignDrivers(vector<Driver>& drivers, vector<Passenger>& passengers) {
     vector<int> assigned = hungarian.getAssigned();
 
       // output the assignment
-    for (int i = 0; i < n; ++i) {
+    for (int i = 0; i < rows; ++i) {
         int passengerId = assigned[i];
+        if (passengerId == -1) {
+            cout << "Driver " << drivers[i].id << " has no passenger" << endl;
+            continue;
+        }
         cout << "Driver " << drivers[i].id << " assigned to Passenger " << passengers[passengerId].id << endl;
     }
 }
 
-  // main simulation loop
-void simulateRideSharing() {
+      // function to assign drivers to passengers with the auction, each passenger only considers
+      // its nearest drivers by straight line distance
+void assignNearestDrivers(vector<Driver>& drivers, vector<Passenger>& passengers, int nearest, int threads = 0) {
+    int rows = drivers.size(), cols = passengers.size();
+    AuctionAlgorithm auction(rows, cols);
+    vector<pair<double, int>> byDistance(rows);
+    for (int j = 0; j < cols; ++j) {
+        for (int i = 0; i < rows; ++i) byDistance[i] = {drivers[i].location.distance(passengers[j].location), i};
+        int k = min(nearest, rows);
+        partial_sort(byDistance.begin(), byDistance.begin() + k, byDistance.end());
+        for (int q = 0; q < k; ++q) auction.addCandidate(byDistance[q].second, j, byDistance[q].first);
+    }
+
+    double cost = auction.minimizeCost(0, threads);
+    vector<int> assigned = auction.getAssigned();
+    for (int i = 0; i < rows; ++i) {
+        int passengerId = assigned[i];
+        if (passengerId == -1) {
+            cout << "Driver " << drivers[i].id << " has no passenger" << endl;
+            continue;
+        }
+        cout << "Driver " << drivers[i].id << " assigned to Passenger " << passengers[passengerId].id << endl;
+    }
+    cout << "total distance " << cost << ", at most " << auction.getGap() << " above optimal" << endl;
+}
+
+      // drivers and passengers matched zone by zone, see matchByZones
+struct ZoneMatching {
+    vector<int> assigned; // passenger index of every driver, -1 if none
+    int matched = 0;
+    double cost = 0;      // total straight line distance of the pairs
+};
+
+      // matches the drivers dIndex to the passengers pIndex on straight line distance, with the hungarian
+      // algorithm or the greedy matcher, and writes the pairs into assigned
+void matchGroup(const vector<Driver>& drivers, const vector<Passenger>& passengers, const vector<int>& dIndex,
+                const vector<int>& pIndex, bool greedy, vector<int>& assigned) {
+    if (dIndex.empty() || pIndex.empty()) return;
+    int rows = dIndex.size(), cols = pIndex.size();
+    if (greedy) {
+        vector<Point> d(rows), p(cols);
+        for (int i = 0; i < rows; ++i) d[i] = {i, drivers[dIndex[i]].location.x, drivers[dIndex[i]].location.y};
+        for (int j = 0; j < cols; ++j) p[j] = {j, passengers[pIndex[j]].location.x, passengers[pIndex[j]].location.y};
+        RideSharingProblem problem(d, p);
+        for (int j = 0; j < cols; ++j) {
+            int i = problem.findBestChoice(p[j]);
+            if (!problem.isValidChoice(i)) break;
+            problem.updateProblem(i);
+            assigned[dIndex[i]] = pIndex[j];
+        }
+        return;
+    }
+    HungarianAlgorithm hungarian(rows, cols);
+    for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < cols; ++j) hungarian.setCost(i, j, drivers[dIndex[i]].location.distance(passengers[pIndex[j]].location));
+    }
+    hungarian.minimizeCost();
+    vector<int> pairs = hungarian.getAssigned();
+    for (int i = 0; i < rows; ++i) {
+        if (pairs[i] != -1) assigned[dIndex[i]] = pIndex[pairs[i]];
+    }
+}
+
+      // zone partitioned matching. drivers and passengers are split over a grid of about the given number of
+      // zones and every zone is matched on its own, the zones handed out to a pool of threads.
+      // no pair crosses a zone border that way, so a second grid shifted by half a zone puts every border in
+      // the middle of a zone: there the pairs with an end near a border and everyone still unmatched are
+      // matched again, and the new pairs kept unless they match fewer or cost more. Whoever is left unmatched
+      // after that is matched in one last problem, so as many pairs are matched as a global solve would
+ZoneMatching matchByZones(const vector<Driver>& drivers, const vector<Passenger>& passengers, int zones, bool greedy = false, int threads = 0) {
+    if (threads <= 0) threads = max(1u, thread::hardware_concurrency());
+    int rows = drivers.size(), cols = passengers.size();
+    ZoneMatching result;
+    result.assigned.assign(rows, -1);
+    if (rows == 0 || cols == 0) return result;
+
+    double minX = drivers[0].location.x, maxX = minX, minY = drivers[0].location.y, maxY = minY;
+    auto extend = [&](const Location& l) {
+        minX = min(minX, l.x);
+        maxX = max(maxX, l.x);
+        minY = min(minY, l.y);
+        maxY = max(maxY, l.y);
+    };
+    for (const Driver& d : drivers) extend(d.location);
+    for (const Passenger& p : passengers) extend(p.location);
+    int across = max(1, (int)ceil(sqrt((double)max(zones, 1))));
+    int down = max(1, (max(zones, 1) + across - 1) / across);
+    double width = max((maxX - minX) / across, 1e-9), height = max((maxY - minY) / down, 1e-9);
+
+      // zone of a location on the grid, shift 0.5 for the grid moved by half a zone which has one more of each
+    auto zoneOf = [&](const Location& l, double shift) {
+        int columns = across + (shift > 0), lines = down + (shift > 0);
+        int x = (int)min((double)columns - 1, max(0.0, floor((l.x - minX) / width + shift)));
+        int y = (int)min((double)lines - 1, max(0.0, floor((l.y - minY) / height + shift)));
+        return y * columns + x;
+    };
+      // within a quarter zone of a border between two zones
+    auto nearBorder = [&](const Location& l) {
+        double fx = (l.x - minX) / width, fy = (l.y - minY) / height;
+        double dx = fabs(fx - round(fx)), dy = fabs(fy - round(fy));
+        bool inside = fx > 0.5 && fx < across - 0.5, insideY = fy > 0.5 && fy < down - 0.5;
+        return (inside && dx < 0.25) || (insideY && dy < 0.25);
+    };
+
+      // solves every group of the given drivers and passengers on the pool, then keeps the new pairs of
+      // a group unless they match fewer or cost more than the ones it had
+    vector<int> trial(rows, -1);
+    auto solveGroups = [&](const vector<vector<int>>& groupDrivers, const vector<vector<int>>& groupPassengers) {
+        atomic<int> cursor{0};
+        auto worker = [&]() {
+            for (int g; (g = cursor.fetch_add(1, memory_order_relaxed)) < (int)groupDrivers.size();) {
+                const vector<int>& d = groupDrivers[g];
+                for (int i : d) trial[i] = -1;
+                matchGroup(drivers, passengers, d, groupPassengers[g], greedy, trial);
+                int before = 0, after = 0;
+                double oldCost = 0, newCost = 0;
+                for (int i : d) {
+                    if (result.assigned[i] != -1) {
+                        before++;
+                        oldCost += drivers[i].location.distance(passengers[result.assigned[i]].location);
+                    }
+                    if (trial[i] != -1) {
+                        after++;
+                        newCost += drivers[i].location.distance(passengers[trial[i]].location);
+                    }
+                }
+                if (after < before || (after == before && newCost >= oldCost)) continue;
+                for (int i : d) result.assigned[i] = trial[i];
+            }
+        };
+        vector<thread> pool;
+        for (int t = 1; t < threads; ++t) pool.emplace_back(worker);
+        worker();
+        for (thread& th : pool) th.join();
+    };
+
+      // every zone on its own
+    vector<vector<int>> groupDrivers(across * down), groupPassengers(across * down);
+    for (int i = 0; i < rows; ++i) groupDrivers[zoneOf(drivers[i].location, 0)].push_back(i);
+    for (int j = 0; j < cols; ++j) groupPassengers[zoneOf(passengers[j].location, 0)].push_back(j);
+    solveGroups(groupDrivers, groupPassengers);
+
+      // the borders again on the shifted grid: pairs with both ends in one shifted zone and one near a border,
+      // and the unmatched drivers and passengers
+    vector<int> driverOf(cols, -1);
+    for (int i = 0; i < rows; ++i) {
+        if (result.assigned[i] != -1) driverOf[result.assigned[i]] = i;
+    }
+    groupDrivers.assign((across + 1) * (down + 1), {});
+    groupPassengers.assign((across + 1) * (down + 1), {});
+    for (int i = 0; i < rows; ++i) {
+        int zone = zoneOf(drivers[i].location, 0.5), j = result.assigned[i];
+        if (j != -1) {
+            const Location& other = passengers[j].location;
+            if (zoneOf(other, 0.5) != zone || !(nearBorder(drivers[i].location) || nearBorder(other))) continue;
+            groupPassengers[zone].push_back(j);
+        }
+        groupDrivers[zone].push_back(i);
+    }
+    for (int j = 0; j < cols; ++j) {
+        if (driverOf[j] == -1) groupPassengers[zoneOf(passengers[j].location, 0.5)].push_back(j);
+    }
+    solveGroups(groupDrivers, groupPassengers);
+
+      // whoever is still unmatched, all together
+    fill(driverOf.begin(), driverOf.end(), -1);
+    vector<int> leftDrivers, leftPassengers;
+    for (int i = 0; i < rows; ++i) {
+        if (result.assigned[i] != -1) driverOf[result.assigned[i]] = i;
+        else leftDrivers.push_back(i);
+    }
+    for (int j = 0; j < cols; ++j) {
+        if (driverOf[j] == -1) leftPassengers.push_back(j);
+    }
+    matchGroup(drivers, passengers, leftDrivers, leftPassengers, greedy, result.assigned);
+
+    for (int i = 0; i < rows; ++i) {
+        if (result.assigned[i] == -1) continue;
+        result.matched++;
+        result.cost += drivers[i].location.distance(passengers[result.assigned[i]].location);
+    }
+    return result;
+}
+
+      // match drivers and passengers read from input by zones and compare with one global solve:
+      // a count of drivers and their x y followed by a count of passengers and their x y
+void simulateZoneMatching(int zones, bool greedy, int threads) {
+    vector<Driver> drivers;
+    vector<Passenger> passengers;
+    int count;
+    double x, y;
+    cin >> count;
+    for (int i = 0; i < count && cin >> x >> y; ++i) drivers.push_back({i + 1, {x, y}, true});
+    cin >> count;
+    for (int i = 0; i < count && cin >> x >> y; ++i) passengers.push_back({i + 1, {x, y}, {x, y}, false});
+
+    auto start = chrono::steady_clock::now();
+    ZoneMatching zoned = matchByZones(drivers, passengers, zones, greedy, threads);
+    double zonedTime = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    for (size_t i = 0; i < drivers.size(); ++i) {
+        if (zoned.assigned[i] == -1) cout << "Driver " << drivers[i].id << " has no passenger" << endl;
+        else cout << "Driver " << drivers[i].id << " assigned to Passenger " << passengers[zoned.assigned[i]].id << endl;
+    }
+
+    start = chrono::steady_clock::now();
+    ZoneMatching global = matchByZones(drivers, passengers, 1, greedy, 1);
+    double globalTime = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    cout << "zones: " << zoned.matched << " pairs, distance " << zoned.cost << ", " << zonedTime << " ms" << endl;
+    cout << "global: " << global.matched << " pairs, distance " << global.cost << ", " << globalTime << " ms" << endl;
+    cout << "gap: " << zoned.cost - global.cost;
+    if (global.cost > 0) cout << " (" << 100 * (zoned.cost - global.cost) / global.cost << "%)";
+    cout << endl;
+}
+
+      // ride pooling: a vehicle carries several passengers at once and picks them up and drops them off
+      // in any order that keeps every passenger within its limits. Travel is at unit speed on straight
+      // lines, so times and distances are the same and every deadline counts from now.
+struct PoolingOptions {
+    int capacity = 4;       // seats per vehicle
+    int maxGroup = 3;       // most new passengers given to one vehicle in a tick
+    double maxWait = 5;     // latest pickup
+    double maxDetour = 0.5; // latest drop off is the latest pickup plus the direct ride this much longer
+    int threads = 0;
+};
+
+      // one stop on a vehicle's route
+struct PoolStop {
+    int passenger;     // passenger id
+    bool pickup;       // pickup or drop off
+    Location location;
+    double latest;     // deadline
+};
+
+      // a vehicle with the passengers on board and the stops it still has to make. Passengers on board
+      // only have their drop off left in stops
+struct PoolVehicle {
+    int id;
+    Location location;
+    int onboard = 0;
+    vector<PoolStop> stops;
+};
+
+struct PoolingResult {
+    vector<int> vehicleOf;  // vehicle index of every passenger, -1 if none takes it
+    int served = 0;
+    int shared = 0;         // vehicles given more than one new passenger
+    double added = 0;       // distance the routes grew by
+    int edges = 0;          // pairs of passengers in the shareability graph
+    long long trips = 0;    // trips found feasible for some vehicle
+};
+
+      // bucket grid over a set of locations for the ones within a radius of a point
+class PointGrid {
+private:
+    double minX = 0, minY = 0, cell = 1;
+    int across = 1, down = 1;
+    vector<int> start, items;
+    const vector<Location>& points;
+
+    int cellX(double x) const {
+        return (int)min((double)across - 1, max(0.0, floor((x - minX) / cell)));
+    }
+    int cellY(double y) const {
+        return (int)min((double)down - 1, max(0.0, floor((y - minY) / cell)));
+    }
+
+public:
+      // cells are as wide as the radius searched later, made wider when that would give far more cells than points
+    PointGrid(const vector<Location>& points, double radius) : points(points) {
+        if (points.empty()) {
+            start.assign(2, 0);
+            return;
+        }
+        double maxX = points[0].x, maxY = points[0].y;
+        minX = maxX;
+        minY = maxY;
+        for (const Location& l : points) {
+            minX = min(minX, l.x);
+            maxX = max(maxX, l.x);
+            minY = min(minY, l.y);
+            maxY = max(maxY, l.y);
+        }
+        double limit = 4.0 * points.size() + 16;
+        cell = max(radius, 1e-9);
+        while ((floor((maxX - minX) / cell) + 1) * (floor((maxY - minY) / cell) + 1) > limit) cell *= 2;
+        across = (int)floor((maxX - minX) / cell) + 1;
+        down = (int)floor((maxY - minY) / cell) + 1;
+        start.assign((size_t)across * down + 1, 0);
+        for (const Location& l : points) start[cellY(l.y) * across + cellX(l.x) + 1]++;
+        for (size_t c = 1; c < start.size(); ++c) start[c] += start[c - 1];
+        items.resize(points.size());
+        vector<int> fill(start.begin(), start.end() - 1);
+        for (size_t k = 0; k < points.size(); ++k) items[fill[cellY(points[k].y) * across + cellX(points[k].x)]++] = k;
+    }
+
+      // calls f with the index of every point within radius of l, in increasing order of cell
+    template <class F>
+    void near(const Location& l, double radius, F f) const {
+        if (items.empty()) return;
+        int x0 = cellX(l.x - radius), x1 = cellX(l.x + radius), y0 = cellY(l.y - radius), y1 = cellY(l.y + radius);
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                for (int k = start[y * across + x]; k < start[y * across + x + 1]; ++k) {
+                    if (points[items[k]].distance(l) <= radius) f(items[k]);
+                }
+            }
+        }
+    }
+};
+
+      // drives the stops in order from start, false if a stop is reached after its deadline or the
+      // vehicle would carry more than capacity. length is the distance driven
+bool routeFeasible(const Location& start, const vector<PoolStop>& stops, int onboard, int capacity, double& length) {
+    Location at = start;
+    double time = 0;
+    int load = onboard;
+    for (const PoolStop& stop : stops) {
+        time += at.distance(stop.location);
+        if (time > stop.latest) return false;
+        load += stop.pickup ? 1 : -1;
+        if (load > capacity) return false;
+        at = stop.location;
+    }
+    length = time;
+    return true;
+}
+
+      // cheapest insertion of a pickup and its drop off into stops, the stops already there keep their order.
+      // returns the distance the route grows by and writes the new route into best, UNASSIGNABLE if no
+      // insertion keeps the route feasible
+double insertRequest(const Location& start, int onboard, int capacity, const vector<PoolStop>& stops,
+                     const PoolStop& pickup, const PoolStop& dropoff, vector<PoolStop>& best) {
+    double base;
+    if (!routeFeasible(start, stops, onboard, capacity, base)) return UNASSIGNABLE;
+    int n = stops.size();
+      // time the vehicle reaches each stop on the current route, the pickup cannot go after one it reaches too late
+    vector<double> arrival(n + 1, 0);
+    Location at = start;
+    for (int k = 0; k < n; ++k) {
+        arrival[k + 1] = arrival[k] + at.distance(stops[k].location);
+        at = stops[k].location;
+    }
+    double bestCost = UNASSIGNABLE;
+    vector<PoolStop> route;
+    route.reserve(n + 2);
+    for (int i = 0; i <= n; ++i) {
+        Location before = i == 0 ? start : stops[i - 1].location;
+        if (arrival[i] + before.distance(pickup.location) > pickup.latest) {
+            if (arrival[i] > pickup.latest) break;
+            continue;
+        }
+        for (int j = i; j <= n; ++j) {
+            route.assign(stops.begin(), stops.begin() + i);
+            route.push_back(pickup);
+            route.insert(route.end(), stops.begin() + i, stops.begin() + j);
+            route.push_back(dropoff);
+            route.insert(route.end(), stops.begin() + j, stops.end());
+            double length;
+            if (!routeFeasible(start, route, onboard, capacity, length) || length - base >= bestCost) continue;
+            bestCost = length - base;
+            best = route;
+        }
+    }
+    return bestCost;
+}
+
+      // pooled matching of the waiting passengers to the vehicles, every vehicle keeps the stops it has.
+      //  - shareability graph: two passengers are linked when one vehicle could serve both, starting at the
+      //    pickup of either. Pickups further apart than the wait limit can never share, so only the pairs
+      //    a grid finds within that distance are tried
+      //  - every vehicle looks at the passengers it can reach before their pickup deadline and builds trips
+      //    of one, two, up to maxGroup of them. A trip of k passengers is only tried when all its trips of
+      //    k-1 passengers were feasible for that vehicle, and its new route comes from inserting the last
+      //    passenger into the route of the others. Vehicles are handed out to a pool of threads
+      //  - trips go to vehicles greedily, the trips with the most passengers first and then the ones that
+      //    add the least distance, skipping vehicles already given a trip and passengers already served
+      // the chosen routes replace the stops of the vehicles
+PoolingResult matchPooled(vector<PoolVehicle>& vehicles, const vector<Passenger>& passengers, const PoolingOptions& options) {
+    int threads = options.threads > 0 ? options.threads : max(1u, thread::hardware_concurrency());
+    int rows = vehicles.size(), cols = passengers.size();
+    PoolingResult result;
+    result.vehicleOf.assign(cols, -1);
+    if (rows == 0 || cols == 0) return result;
+
+    auto forEach = [&](int count, auto body) {
+        atomic<int> cursor{0};
+        auto worker = [&]() {
+            for (int k; (k = cursor.fetch_add(1, memory_order_relaxed)) < count;) body(k);
+        };
+        vector<thread> pool;
+        for (int t = 1; t < min(threads, count); ++t) pool.emplace_back(worker);
+        worker();
+        for (thread& th : pool) th.join();
+    };
+
+      // the stops of every passenger
+    vector<PoolStop> pickups(cols), dropoffs(cols);
+    vector<Location> origins(cols);
+    for (int j = 0; j < cols; ++j) {
+        const Passenger& p = passengers[j];
+        double direct = p.location.distance(p.destination);
+        pickups[j] = {p.id, true, p.location, options.maxWait};
+        dropoffs[j] = {p.id, false, p.destination, options.maxWait + direct * (1 + options.maxDetour)};
+        origins[j] = p.location;
+    }
+    PointGrid pickupGrid(origins, options.maxWait);
+
+      // shareability graph, sorted neighbours of every passenger
+    vector<vector<int>> shareable(cols);
+    forEach(cols, [&](int a) {
+        vector<PoolStop> alone, both;
+        pickupGrid.near(origins[a], options.maxWait, [&](int b) {
+            if (b == a) return;
+            for (int first : {a, b}) {
+                int second = first == a ? b : a;
+                alone.assign({pickups[first], dropoffs[first]});
+                if (insertRequest(origins[first], 0, options.capacity, alone, pickups[second], dropoffs[second], both) != UNASSIGNABLE) {
+                    shareable[a].push_back(b);
+                    return;
+                }
+            }
+        });
+        sort(shareable[a].begin(), shareable[a].end());
+    });
+    for (int a = 0; a < cols; ++a) result.edges += shareable[a].size();
+    result.edges /= 2;
+
+      // feasible trips of every vehicle, passengers of a trip in increasing order
+    struct Trip {
+        vector<int> members;
+        vector<PoolStop> stops;
+        double added;
+    };
+    vector<vector<Trip>> trips(rows);
+    forEach(rows, [&](int v) {
+        PoolVehicle& vehicle = vehicles[v];
+        vector<Trip>& found = trips[v];
+        double base;
+        if (!routeFeasible(vehicle.location, vehicle.stops, vehicle.onboard, options.capacity, base)) return;
+        vector<PoolStop> route;
+        pickupGrid.near(vehicle.location, options.maxWait, [&](int j) {
+            double added = insertRequest(vehicle.location, vehicle.onboard, options.capacity, vehicle.stops, pickups[j], dropoffs[j], route);
+            if (added != UNASSIGNABLE) found.push_back({{j}, route, added});
+        });
+        sort(found.begin(), found.end(), [](const Trip& a, const Trip& b) { return a.members < b.members; });
+        vector<int> reachable;
+        for (const Trip& t : found) reachable.push_back(t.members[0]);
+
+        size_t levelStart = 0;
+        for (int size = 2; size <= options.maxGroup; ++size) {
+            size_t levelEnd = found.size();
+            if (levelEnd == levelStart) break;
+              // trips of the previous size, sorted, to look up the sub trips of a candidate
+            vector<vector<int>> previous;
+            for (size_t t = levelStart; t < levelEnd; ++t) previous.push_back(found[t].members);
+            vector<int> candidate;
+            for (size_t t = levelStart; t < levelEnd; ++t) {
+                for (int r : reachable) {
+                    if (r <= found[t].members.back()) continue;
+                    bool linked = true;
+                    for (int m : found[t].members) linked = linked && binary_search(shareable[m].begin(), shareable[m].end(), r);
+                    if (!linked) continue;
+                    candidate = found[t].members;
+                    candidate.push_back(r);
+                    bool subtrips = true;
+                    for (size_t drop = 0; drop + 1 < candidate.size() && subtrips; ++drop) {
+                        vector<int> sub = candidate;
+                        sub.erase(sub.begin() + drop);
+                        subtrips = binary_search(previous.begin(), previous.end(), sub);
+                    }
+                    if (!subtrips) continue;
+                    double grown = insertRequest(vehicle.location, vehicle.onboard, options.capacity, found[t].stops, pickups[r], dropoffs[r], route);
+                    if (grown == UNASSIGNABLE) continue;
+                    found.push_back({candidate, route, found[t].added + grown});
+                }
+            }
+            levelStart = levelEnd;
+        }
+    });
+
+      // greedy assignment of trips to vehicles
+    vector<pair<int, int>> order; // vehicle and trip
+    for (int v = 0; v < rows; ++v) {
+        result.trips += trips[v].size();
+        for (size_t t = 0; t < trips[v].size(); ++t) order.push_back({v, t});
+    }
+    sort(order.begin(), order.end(), [&](const pair<int, int>& a, const pair<int, int>& b) {
+        const Trip& x = trips[a.first][a.second];
+        const Trip& y = trips[b.first][b.second];
+        if (x.members.size() != y.members.size()) return x.members.size() > y.members.size();
+        if (x.added != y.added) return x.added < y.added;
+        return a < b;
+    });
+    vector<bool> busy(rows, false);
+    for (const pair<int, int>& choice : order) {
+        int v = choice.first;
+        const Trip& trip = trips[v][choice.second];
+        if (busy[v]) continue;
+        bool open = true;
+        for (int j : trip.members) open = open && result.vehicleOf[j] == -1;
+        if (!open) continue;
+        busy[v] = true;
+        for (int j : trip.members) result.vehicleOf[j] = v;
+        vehicles[v].stops = trip.stops;
+        result.served += trip.members.size();
+        result.shared += trip.members.size() > 1;
+        result.added += trip.added;
+    }
+    return result;
+}
+
+      // pooled matching of drivers and passengers read from input: a count of drivers and their x y followed
+      // by a count of passengers and the x y of their pickup and of their destination
+void simulatePooling(const PoolingOptions& options) {
+    vector<PoolVehicle> vehicles;
+    vector<Passenger> passengers;
+    int count;
+    double x, y, toX, toY;
+    cin >> count;
+    for (int i = 0; i < count && cin >> x >> y; ++i) vehicles.push_back({i + 1, {x, y}, 0, {}});
+    cin >> count;
+    for (int i = 0; i < count && cin >> x >> y >> toX >> toY; ++i) passengers.push_back({i + 1, {x, y}, {toX, toY}, false});
+
+    auto start = chrono::steady_clock::now();
+    PoolingResult pooled = matchPooled(vehicles, passengers, options);
+    double time = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    for (const PoolVehicle& vehicle : vehicles) {
+        if (vehicle.stops.empty()) continue;
+        cout << "Driver " << vehicle.id << ":";
+        for (const PoolStop& stop : vehicle.stops) cout << (stop.pickup ? " pick up " : " drop off ") << stop.passenger;
+        cout << endl;
+    }
+    for (size_t j = 0; j < passengers.size(); ++j) {
+        if (pooled.vehicleOf[j] == -1) cout << "Passenger " << passengers[j].id << " has no driver" << endl;
+    }
+    cout << "pooled: " << pooled.served << " of " << passengers.size() << " passengers on " << vehicles.size()
+         << " drivers, " << pooled.shared << " shared rides, added distance " << pooled.added << endl;
+    cout << "shareability graph: " << pooled.edges << " pairs, " << pooled.trips << " feasible trips, " << time << " ms" << endl;
+}
+
+      // concurrent table of driver state shared by the threads that take in driver events and the matchers.
+      // the state is a structure of arrays indexed by slot: id, position, status and version, and a map
+      // from driver id to slot.
+      //  - a snapshot never waits: it reads a slot between two loads of its version as a seqlock does,
+      //    and a slot caught mid-update three times in a row is left out of that snapshot
+      //  - a matcher takes a driver with one compare-and-swap of its status from available to busy,
+      //    so of two matchers that picked the same driver only one gets it. The status word also counts
+      //    every change of status, a driver seen in a snapshot cannot be taken once its status moved on,
+      //    even if it came back to available or its slot went to another driver
+      //  - a slot is only ever available while the map links its driver to it, so no driver is available
+      //    in two slots at once or taken twice
+      //  - the slot of a driver that goes offline is handed to a new driver only after every thread that
+      //    may still be writing to it has moved on: writers announce the epoch they work in, a slot waits on
+      //    the list of the global epoch at the time it was retired, and the list is freed by the writer that
+      //    moves the epoch two steps past it, when every writer that could have seen the slot has left
+      //  - writers of one driver take turns on its version, writers of different drivers never meet
+class DriverRegistry {
+public:
+    enum Status { OFFLINE = 0, AVAILABLE = 1, BUSY = 2 };
+      // a driver as a snapshot saw it, state is what claim compares against
+    struct View {
+        int slot, id;
+        double x, y;
+        uint64_t state;
+    };
+
+      // ids are 0 .. maxId - 1, at most capacity drivers at once and maxWriters threads changing them
+    DriverRegistry(int maxId, int capacity, int maxWriters = 64)
+        : maxId(maxId), capacity(capacity), maxWriters(maxWriters), slotOf(new atomic<int>[maxId]),
+          ids(new atomic<int>[capacity]), xs(new atomic<double>[capacity]), ys(new atomic<double>[capacity]),
+          states(new atomic<uint64_t>[capacity]), versions(new atomic<uint64_t>[capacity]),
+          nextFree(new atomic<int>[capacity]), writers(new Writer[maxWriters]) {
+        for (int k = 0; k < maxId; ++k) slotOf[k].store(-1, memory_order_relaxed);
+        for (int s = 0; s < capacity; ++s) {
+            ids[s].store(-1, memory_order_relaxed);
+            xs[s].store(0, memory_order_relaxed);
+            ys[s].store(0, memory_order_relaxed);
+            states[s].store(OFFLINE, memory_order_relaxed);
+            versions[s].store(0, memory_order_relaxed);
+            nextFree[s].store(-1, memory_order_relaxed);
+        }
+    }
+
+      // a handle for a thread that changes drivers, every such thread needs its own. -1 once all are taken
+    int join() {
+        int handle = joined.fetch_add(1);
+        return handle < maxWriters ? handle : -1;
+    }
+
+      // the driver moved, a driver not seen before joins busy
+    bool move(int handle, int id, double x, double y) {
+        return change(handle, id, true, x, y, -1);
+    }
+
+      // the driver is free to take a ride or busy, with a new position if hasLocation.
+      // a driver not seen before needs a position to join
+    bool setAvailable(int handle, int id, bool available, bool hasLocation = false, double x = 0, double y = 0) {
+        return change(handle, id, hasLocation, x, y, available ? AVAILABLE : BUSY);
+    }
+
+      // the driver leaves, its slot is reused once no writer can still be using it. The slot goes offline
+      // before it is unlinked, so the driver cannot join again in another slot while this one is still
+      // available. Of two threads taking the same driver offline the one that unlinks it retires the slot
+    void goOffline(int handle, int id) {
+        if (id < 0 || id >= maxId || handle < 0) return;
+        enter(handle);
+        int s = slotOf[id].load();
+        if (s != -1) {
+            uint64_t seen = states[s].load(memory_order_relaxed);
+            while (!states[s].compare_exchange_weak(seen, ((seen >> 2) + 1) << 2 | OFFLINE)) {}
+            if (slotOf[id].compare_exchange_strong(s, -1)) retire(s);
+        }
+        leave(handle);
+    }
+
+      // the available drivers as they are now, without waiting on any writer. A driver whose state moved
+      // on while the slots were read is left out: it could not be claimed anyway, and a driver that went
+      // offline and came back in another slot is then only in it once
+    void snapshot(vector<View>& out) const {
+        out.clear();
+        int used = min(capacity, highWater.load(memory_order_acquire));
+        for (int s = 0; s < used; ++s) {
+            for (int attempt = 0; attempt < 3; ++attempt) {
+                uint64_t before = versions[s].load(memory_order_acquire);
+                if (before & 1) continue;
+                View view = {s, ids[s].load(memory_order_relaxed), xs[s].load(memory_order_relaxed),
+                             ys[s].load(memory_order_relaxed), states[s].load(memory_order_relaxed)};
+                atomic_thread_fence(memory_order_acquire);
+                if (versions[s].load(memory_order_relaxed) != before) continue;
+                if ((view.state & 3) == AVAILABLE) out.push_back(view);
+                break;
+            }
+        }
+        out.erase(remove_if(out.begin(), out.end(), [this](const View& view) { return states[view.slot].load() != view.state; }),
+                  out.end());
+    }
+
+      // take a driver seen in a snapshot for a ride. False if it has been taken, went busy or offline since
+    bool claim(const View& view) {
+        uint64_t expected = view.state;
+        return (expected & 3) == AVAILABLE && states[view.slot].compare_exchange_strong(expected, ((expected >> 2) + 1) << 2 | BUSY);
+    }
+
+      // checks the table while no writer is inside: every driver's slot holds its id and no other driver,
+      // and every other slot handed out is on the free stack or a retired list, on exactly one of them
+    bool consistent() const {
+        int used = min(capacity, highWater.load());
+        vector<int> owner(capacity, -1); // driver id of a slot, -2 once seen on a list
+        int live = 0, listed = 0;
+        for (int id = 0; id < maxId; ++id) {
+            int s = slotOf[id].load();
+            if (s == -1) continue;
+            if (s < 0 || s >= used || owner[s] != -1 || ids[s].load() != id || (states[s].load() & 3) == OFFLINE) return false;
+            owner[s] = id;
+            live++;
+        }
+        for (int list = 0; list < 4; ++list) {
+            for (int s = list == 3 ? freeTop.load() : retiredTop[list].load(); s != -1; s = nextFree[s].load()) {
+                if (s < 0 || s >= used || owner[s] != -1) return false;
+                owner[s] = -2;
+                listed++;
+            }
+        }
+        return live + listed == used;
+    }
+
+private:
+    static const uint64_t IDLE = ~0ull;
+    struct alignas(64) Writer {
+        atomic<uint64_t> epoch{IDLE};
+    };
+    int maxId, capacity, maxWriters;
+    unique_ptr<atomic<int>[]> slotOf;
+    unique_ptr<atomic<int>[]> ids;
+    unique_ptr<atomic<double>[]> xs, ys;
+    unique_ptr<atomic<uint64_t>[]> states;   // changes of status << 2 | status
+    unique_ptr<atomic<uint64_t>[]> versions; // odd while a writer is in the slot
+    unique_ptr<atomic<int>[]> nextFree;      // links of the stacks of free and retired slots
+    atomic<int> freeTop{-1};
+    atomic<int> retiredTop[3] = {{-1}, {-1}, {-1}}; // slots retired in each epoch, by epoch % 3
+    atomic<int> highWater{0};                // slots ever handed out
+    unique_ptr<Writer[]> writers;
+    atomic<int> joined{0};
+    atomic<uint64_t> epoch{0};
+
+    void enter(int handle) {
+        Writer& w = writers[handle];
+        uint64_t now = epoch.load();
+        while (true) {
+            w.epoch.store(now, memory_order_seq_cst);
+            uint64_t again = epoch.load();
+            if (again == now) break;
+            now = again;
+        }
+    }
+
+      // the epoch moves on once every writer inside one is in the current one, and the writer whose
+      // compare-and-swap moved it frees the slots retired two epochs back. A writer that could still hold one
+      // of them entered before it was retired, so at that epoch or the one before, and has left by now.
+      // nobody retires into that list again while this writer still holds the epoch before the new one
+    void leave(int handle) {
+        Writer& w = writers[handle];
+        uint64_t now = epoch.load();
+        bool quiet = w.epoch.load(memory_order_relaxed) == now;
+        int count = min(maxWriters, joined.load());
+        for (int k = 0; k < count && quiet; ++k) {
+            uint64_t seen = writers[k].epoch.load();
+            if (seen != IDLE && seen != now) quiet = false;
+        }
+        if (quiet && epoch.compare_exchange_strong(now, now + 1)) {
+            for (int s = retiredTop[(now + 2) % 3].exchange(-1); s != -1;) {
+                int next = nextFree[s].load(memory_order_relaxed);
+                push(freeTop, s);
+                s = next;
+            }
+        }
+        w.epoch.store(IDLE, memory_order_release);
+    }
+
+      // after the slot is unlinked, under the global epoch and not the writer's own, which may be behind
+      // a writer that entered since and still saw the slot
+    void retire(int s) {
+        push(retiredTop[epoch.load() % 3], s);
+    }
+
+    void push(atomic<int>& top, int s) {
+        int seen = top.load();
+        do {
+            nextFree[s].store(seen, memory_order_relaxed);
+        } while (!top.compare_exchange_weak(seen, s));
+    }
+
+      // a free slot, -1 when all are in use. Called inside an epoch: a slot another writer takes from under
+      // this one is retired no earlier than this writer's epoch and only freed two epochs later, so it cannot
+      // be back on top before this returns and fool the compare-and-swap
+    int takeSlot() {
+        int top = freeTop.load();
+        while (top != -1 && !freeTop.compare_exchange_weak(top, nextFree[top].load(memory_order_relaxed))) {}
+        if (top != -1) return top;
+        int s = highWater.load();
+        while (s < capacity && !highWater.compare_exchange_weak(s, s + 1)) {}
+        return s < capacity ? s : -1;
+    }
+
+    void write(int s, int id, double x, double y) {
+        uint64_t version = versions[s].load(memory_order_relaxed);
+        while (true) {
+            if (!(version & 1) && versions[s].compare_exchange_weak(version, version + 1, memory_order_acquire)) break;
+            if (version & 1) {
+                this_thread::yield();
+                version = versions[s].load(memory_order_relaxed);
+            }
+        }
+          // pairs with the fence in snapshot: a reader that sees any of the new fields also sees the odd version
+        atomic_thread_fence(memory_order_release);
+        ids[s].store(id, memory_order_relaxed);
+        xs[s].store(x, memory_order_relaxed);
+        ys[s].store(y, memory_order_relaxed);
+        versions[s].store(version + 2, memory_order_release);
+    }
+
+      // new position if moved, new status unless status is -1
+    bool change(int handle, int id, bool moved, double x, double y, int status) {
+        if (id < 0 || id >= maxId || handle < 0) return false;
+        enter(handle);
+        int s = slotOf[id].load();
+        if (s == -1) {
+              // a driver not seen before: a fresh slot
+            if (!moved || (s = takeSlot()) == -1) {
+                leave(handle);
+                return false;
+            }
+              // the slot stays offline until it is linked, only a linked slot may be available
+            write(s, id, x, y);
+            uint64_t seen = states[s].load();
+            int expected = -1;
+            if (!slotOf[id].compare_exchange_strong(expected, s)) {
+                  // another thread added the same driver first, this slot goes back untouched and its change
+                  // is made there
+                retire(s);
+                s = expected;
+            } else {
+                  // fails only if the driver went offline right after it was linked
+                states[s].compare_exchange_strong(seen, ((seen >> 2) + 1) << 2 | (status == -1 ? BUSY : status));
+                leave(handle);
+                return true;
+            }
+        }
+        if (moved) write(s, id, x, y);
+        if (status != -1) {
+            uint64_t seen = states[s].load();
+            while ((seen & 3) != OFFLINE && (int)(seen & 3) != status &&
+                   !states[s].compare_exchange_weak(seen, ((seen >> 2) + 1) << 2 | status)) {}
+        }
+        leave(handle);
+        return true;
+    }
+};
+
+      // stress check of DriverRegistry: in every round writers threads move drivers of a few ids around, take
+      // them offline and bring them back as fast as they can on a fresh table, while a matcher takes snapshots
+      // and claims every driver in them. A round fails if a snapshot has a driver twice, a driver is claimed
+      // twice from one snapshot, or the table is inconsistent once the writers are done.
+      // Returns the number of rounds that failed
+int churnRegistry(int rounds, int writers, int operations, unsigned long long seed) {
+    const int ids = 16;
+    int broken = 0;
+    for (int round = 0; round < rounds; ++round) {
+        DriverRegistry registry(ids, 2 * ids, writers);
+        atomic<int> running{writers};
+        atomic<bool> twice{false};
+        thread matcher([&registry, &running, &twice]() {
+            vector<DriverRegistry::View> views;
+            vector<int> seen(ids), claimed(ids);
+            while (running.load() > 0) {
+                registry.snapshot(views);
+                fill(seen.begin(), seen.end(), 0);
+                fill(claimed.begin(), claimed.end(), 0);
+                for (const DriverRegistry::View& view : views) {
+                    if (view.id < 0 || view.id >= ids) continue;
+                    if (seen[view.id]++ > 0) twice = true;
+                    if (registry.claim(view) && claimed[view.id]++ > 0) twice = true;
+                }
+            }
+        });
+        vector<thread> threads;
+        for (int t = 0; t < writers; ++t) {
+            threads.emplace_back([&registry, &running, operations, seed, round, t]() {
+                mt19937_64 engine(seed + (unsigned long long)round * 1000003 + t);
+                int handle = registry.join();
+                for (int k = 0; k < operations; ++k) {
+                    int id = engine() % ids, what = engine() % 4;
+                    double x = engine() % 1000, y = engine() % 1000;
+                    if (what == 0) registry.goOffline(handle, id);
+                    else if (what == 1) registry.move(handle, id, x, y);
+                    else registry.setAvailable(handle, id, what == 2, true, x, y);
+                }
+                running.fetch_sub(1);
+            });
+        }
+        for (thread& t : threads) t.join();
+        matcher.join();
+        if (twice || !registry.consistent()) broken++;
+    }
+    return broken;
+}
+
+      // bounded lock-free queue between exactly one producer thread and one consumer thread.
+      // the producer only writes tail and the consumer only writes head, each on its own cache line,
+      // and each side keeps a copy of the other's index so it only reads the shared one when it looks full or empty
+template <typename T>
+class SPSCQueue {
+private:
+    vector<T> slots;
+    size_t mask;
+    alignas(64) atomic<size_t> head{0}; // next slot to pop
+    size_t knownTail = 0;               // the consumer's copy of tail
+    alignas(64) atomic<size_t> tail{0}; // next slot to push
+    size_t knownHead = 0;               // the producer's copy of head
+
+public:
+      // capacity is rounded up to a power of two
+    explicit SPSCQueue(size_t capacity) {
+        size_t size = 1;
+        while (size < max<size_t>(capacity, 2)) size <<= 1;
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    bool tryPush(T& value) {
+        size_t t = tail.load(memory_order_relaxed);
+        if (t - knownHead > mask) {
+            knownHead = head.load(memory_order_acquire);
+            if (t - knownHead > mask) return false;
+        }
+        slots[t & mask] = move(value);
+        tail.store(t + 1, memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T& value) {
+        size_t h = head.load(memory_order_relaxed);
+        if (h == knownTail) {
+            knownTail = tail.load(memory_order_acquire);
+            if (h == knownTail) return false;
+        }
+        value = move(slots[h & mask]);
+        head.store(h + 1, memory_order_release);
+        return true;
+    }
+
+      // waits while the queue is full
+    void push(T value) {
+        while (!tryPush(value)) this_thread::yield();
+    }
+};
+
+      // reads one line holding a flat JSON object into its fields, strings without their quotes
+      // and numbers, true, false and null as written. Returns false if the line is not such an object
+bool parseJsonLine(const string& line, vector<pair<string, string>>& fields) {
+    fields.clear();
+    size_t at = 0;
+    auto skipSpace = [&]() {
+        while (at < line.size() && isspace((unsigned char)line[at])) at++;
+    };
+    auto readString = [&](string& out) {
+        out.clear();
+        if (at >= line.size() || line[at] != '"') return false;
+        for (at++; at < line.size() && line[at] != '"'; at++) {
+            if (line[at] == '\\' && at + 1 < line.size()) {
+                at++;
+                char c = line[at];
+                out += c == 'n' ? '\n' : c == 't' ? '\t' : c;
+            } else {
+                out += line[at];
+            }
+        }
+        if (at >= line.size()) return false;
+        at++;
+        return true;
+    };
+    skipSpace();
+    if (at >= line.size() || line[at] != '{') return false;
+    at++;
+    skipSpace();
+    if (at < line.size() && line[at] == '}') return true;
+    while (at < line.size()) {
+        string key, value;
+        skipSpace();
+        if (!readString(key)) return false;
+        skipSpace();
+        if (at >= line.size() || line[at] != ':') return false;
+        at++;
+        skipSpace();
+        if (at < line.size() && line[at] == '"') {
+            if (!readString(value)) return false;
+        } else {
+            size_t begin = at;
+            while (at < line.size() && line[at] != ',' && line[at] != '}' && !isspace((unsigned char)line[at])) at++;
+            value = line.substr(begin, at - begin);
+            if (value.empty()) return false;
+        }
+        fields.push_back({key, value});
+        skipSpace();
+        if (at < line.size() && line[at] == ',') {
+            at++;
+            continue;
+        }
+        return at < line.size() && line[at] == '}';
+    }
+    return false;
+}
+
+      // one line of the dispatcher's input:
+      //   {"type": "request", "id": 7, "x": 1.5, "y": 2}                  a passenger asks for a ride
+      //   {"type": "driver", "id": 3, "x": 0, "y": 4, "available": true}  a driver comes online, finishes a ride or is busy
+      //   {"type": "driver", "id": 3, "online": false}                    a driver goes offline
+      //   {"type": "location", "id": 3, "x": 0.5, "y": 4}                 a driver moved
+      // lines of any other type are counted and skipped
+struct DispatchEvent {
+    enum Kind { REQUEST, DRIVER, LOCATION, END } kind = END;
+    int id = 0;
+    double x = 0, y = 0;
+    bool hasLocation = false;
+    bool available = true;
+    bool online = true;
+};
+
+bool parseDispatchEvent(const string& line, DispatchEvent& event) {
+    vector<pair<string, string>> fields;
+    if (!parseJsonLine(line, fields)) return false;
+    event = DispatchEvent();
+    bool hasType = false, hasId = false, hasX = false, hasY = false;
+    for (const pair<string, string>& field : fields) {
+        const string& value = field.second;
+        if (field.first == "type") {
+            hasType = true;
+            if (value == "request") event.kind = DispatchEvent::REQUEST;
+            else if (value == "driver") event.kind = DispatchEvent::DRIVER;
+            else if (value == "location") event.kind = DispatchEvent::LOCATION;
+            else return false;
+        } else if (field.first == "id") {
+            hasId = true;
+            event.id = atoi(value.c_str());
+        } else if (field.first == "x") {
+            hasX = true;
+            event.x = atof(value.c_str());
+        } else if (field.first == "y") {
+            hasY = true;
+            event.y = atof(value.c_str());
+        } else if (field.first == "available") {
+            event.available = value == "true" || value == "1";
+        } else if (field.first == "online") {
+            event.online = value == "true" || value == "1";
+        }
+    }
+    event.hasLocation = hasX && hasY;
+    if (!hasType || !hasId) return false;
+    return event.kind == DispatchEvent::DRIVER || event.hasLocation;
+}
+
+      // settings of the streaming dispatcher
+struct DispatchOptions {
+    double windowMs = 100;   // a batch is matched at the latest this long after its first event
+    int batchSize = 256;     // or as soon as this many events came in
+    size_t queueSize = 4096; // room in each queue between the stages
+    bool greedy = false;     // greedy matcher instead of the hungarian algorithm
+    int maxDriverId = 1 << 20;
+    int maxDrivers = 1 << 16; // online at once
+};
+
+      // what the dispatcher did, for the summary line
+struct DispatchStats {
+    long long events = 0, skipped = 0, batches = 0, assignments = 0, dropped = 0;
+    long long waiting = 0; // requests still unmatched at the end
+    double solveMs = 0;
+};
+
+      // long running dispatcher: events come in as JSON lines, are gathered into micro batches and every
+      // batch matches the waiting requests to the available drivers, the assignments go out as JSON lines.
+      // four stages, each on its own thread and linked by bounded lock-free queues:
+      //   reader -> requests -> dispatcher -> batch -> matcher -> result -> dispatcher -> lines -> writer
+      // the reader writes driver events straight into a DriverRegistry, each batch takes a snapshot of it
+      // and every pair found claims its driver there, so a driver that went busy or offline while its batch
+      // was solved is not assigned and its request waits for the next batch.
+      // the dispatcher never waits for the matcher: it keeps taking requests in while a batch is being
+      // solved and sends the next batch once the result of the last is back, so a slow solve makes the
+      // waiting list longer but never stops intake. a batch takes at most batchSize of the waiting requests,
+      // oldest first, so a backlog does not turn into one huge solve
+DispatchStats runDispatcher(istream& in, ostream& out, const DispatchOptions& options) {
+    struct MatchBatch {
+        long long number = 0;
+        vector<DriverRegistry::View> views;
+        vector<Driver> drivers;
+        vector<Passenger> requests;
+        vector<int> assigned; // request index of every driver, filled in by the matcher
+        double solveMs = 0;
+        bool last = false;
+    };
+    DriverRegistry registry(options.maxDriverId, options.maxDrivers);
+    SPSCQueue<DispatchEvent> events(options.queueSize);
+    SPSCQueue<MatchBatch> batches(2), results(2);
+    SPSCQueue<string> lines(options.queueSize);
+    DispatchStats stats;
+    atomic<long long> skipped{0}, driverEvents{0};
+
+    thread reader([&]() {
+        int handle = registry.join();
+        string line;
+        DispatchEvent event;
+        while (getline(in, line)) {
+            if (line.empty()) continue;
+            if (!parseDispatchEvent(line, event)) {
+                skipped.fetch_add(1, memory_order_relaxed);
+                continue;
+            }
+            if (event.kind == DispatchEvent::REQUEST) {
+                events.push(event);
+                continue;
+            }
+            if (event.kind == DispatchEvent::LOCATION) registry.move(handle, event.id, event.x, event.y);
+            else if (!event.online) registry.goOffline(handle, event.id);
+            else registry.setAvailable(handle, event.id, event.available, event.hasLocation, event.x, event.y);
+            driverEvents.fetch_add(1, memory_order_release);
+        }
+        events.push(DispatchEvent());
+    });
+
+    thread matcher([&]() {
+        MatchBatch batch;
+        while (true) {
+            if (!batches.tryPop(batch)) {
+                this_thread::yield();
+                continue;
+            }
+            if (batch.last) break;
+            auto start = chrono::steady_clock::now();
+            vector<int> dIndex(batch.drivers.size()), pIndex(batch.requests.size());
+            for (size_t i = 0; i < dIndex.size(); ++i) dIndex[i] = i;
+            for (size_t j = 0; j < pIndex.size(); ++j) pIndex[j] = j;
+            batch.assigned.assign(batch.drivers.size(), -1);
+            matchGroup(batch.drivers, batch.requests, dIndex, pIndex, options.greedy, batch.assigned);
+            batch.solveMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            results.push(move(batch));
+        }
+    });
+
+    thread writer([&]() {
+        string line;
+        while (true) {
+            if (!lines.tryPop(line)) {
+                this_thread::yield();
+                continue;
+            }
+            if (line.empty()) break;
+            out << line << '\n';
+        }
+        out.flush();
+    });
+
+      // the dispatcher stage runs on the calling thread
+    deque<Passenger> waiting;
+    bool inputDone = false, inFlight = false;
+    int pendingEvents = 0;
+    long long driverEventsSeen = 0;
+    auto batchOpened = chrono::steady_clock::now();
+    MatchBatch batch;
+    DispatchEvent event;
+    while (true) {
+        bool idle = true;
+          // driver events count towards the batch like requests, they may free drivers for waiting requests
+        long long driverEventsNow = driverEvents.load(memory_order_acquire);
+        if (driverEventsNow != driverEventsSeen) {
+            idle = false;
+            if (pendingEvents == 0) batchOpened = chrono::steady_clock::now();
+            pendingEvents += driverEventsNow - driverEventsSeen;
+            stats.events += driverEventsNow - driverEventsSeen;
+            driverEventsSeen = driverEventsNow;
+        }
+          // always drain the requests, also past batchSize or with a batch in flight, so the reader never
+          // waits on a full queue. at most a queue full per round to get to the results in time
+        for (size_t taken = 0; taken < options.queueSize && events.tryPop(event); ++taken) {
+            idle = false;
+            if (event.kind == DispatchEvent::END) {
+                inputDone = true;
+                break;
+            }
+            stats.events++;
+            if (pendingEvents++ == 0) batchOpened = chrono::steady_clock::now();
+            waiting.push_back({event.id, {event.x, event.y}, {event.x, event.y}, false});
+        }
+
+        if (inFlight && results.tryPop(batch)) {
+            idle = false;
+            inFlight = false;
+            stats.solveMs += batch.solveMs;
+              // keep the pairs whose driver could be claimed, the other requests wait for the next batch
+            vector<bool> matched(batch.requests.size(), false);
+            for (size_t i = 0; i < batch.drivers.size(); ++i) {
+                int j = batch.assigned[i];
+                if (j == -1) continue;
+                if (!registry.claim(batch.views[i])) {
+                    stats.dropped++;
+                    if (pendingEvents++ == 0) batchOpened = chrono::steady_clock::now();
+                    continue;
+                }
+                matched[j] = true;
+                stats.assignments++;
+                double distance = batch.drivers[i].location.distance(batch.requests[j].location);
+                lines.push("{\"type\": \"assignment\", \"batch\": " + to_string(batch.number) + ", \"driver\": " +
+                           to_string(batch.drivers[i].id) + ", \"passenger\": " + to_string(batch.requests[j].id) +
+                           ", \"distance\": " + to_string(distance) + "}");
+            }
+              // back to the front, they came in before anything still waiting
+            for (size_t j = batch.requests.size(); j-- > 0;) {
+                if (!matched[j]) waiting.push_front(batch.requests[j]);
+            }
+        }
+
+          // cut a batch once the window is over, enough events came in or the input ended
+        double open = chrono::duration<double, milli>(chrono::steady_clock::now() - batchOpened).count();
+        bool due = pendingEvents >= options.batchSize || (pendingEvents > 0 && open >= options.windowMs) || inputDone;
+        if (!inFlight && due) {
+            MatchBatch next;
+            registry.snapshot(next.views);
+            for (const DriverRegistry::View& view : next.views) next.drivers.push_back({view.id, {view.x, view.y}, true});
+            bool backlog = false;
+            if (!next.drivers.empty() && !waiting.empty()) {
+                next.number = ++stats.batches;
+                size_t take = min(waiting.size(), (size_t)max(options.batchSize, 1));
+                next.requests.assign(waiting.begin(), waiting.begin() + take);
+                waiting.erase(waiting.begin(), waiting.begin() + take);
+                backlog = !waiting.empty();
+                batches.push(move(next));
+                inFlight = true;
+                idle = false;
+            }
+              // requests left over by a full batch make the next one due right away
+            pendingEvents = backlog ? options.batchSize : 0;
+        }
+
+        if (inputDone && !inFlight) break;
+        if (idle) this_thread::yield();
+    }
+
+    MatchBatch last;
+    last.last = true;
+    batches.push(move(last));
+    lines.push("");
+    reader.join();
+    matcher.join();
+    writer.join();
+    stats.skipped = skipped.load();
+    stats.waiting = waiting.size();
+    return stats;
+}
+
+      // tick based city simulation for load testing the matchers. Drivers drive on a grid map along A* routes,
+      // passengers appear on it at a rate that swings over a simulated day, around a few hotspots and anywhere.
+      // every tick the new requests come in, requests that waited too long give up, the idle drivers are matched
+      // to the waiting requests and the new trips routed, and every driver moves. All random numbers are drawn
+      // on one thread from the seed, and the drivers move in parallel without touching each other, so the same
+      // seed gives the same run on any number of threads
+struct FleetOptions {
+    int ticks = 1000;
+    int drivers = 100;
+    unsigned long long seed = 1;
+    double requestRate = 2;     // mean requests per tick
+    double peakShare = 0.5;     // how far the rate swings above and below its mean over a day, 0 keeps it flat
+    int dayLength = 500;        // ticks in one day
+    int hotspots = 4;           // demand clusters around this many random cells
+    double hotspotShare = 0.6;  // share of pickups and destinations drawn near a hotspot, the rest anywhere
+    double hotspotSpread = 5;   // standard deviation of their distance from the hotspot in cells
+    int speed = 1;              // cells a driver moves in a tick
+    int patience = 60;          // ticks a request waits for a driver before it gives up
+    int threads = 0;
+    bool trace = false;         // print one line per tick
+};
+
+struct FleetStats {
+    int requests = 0;
+    int pickedUp = 0;
+    int completed = 0;
+    int abandoned = 0;          // gave up waiting
+    double meanWait = 0, p95Wait = 0;  // ticks from request to pickup
+    double deadhead = 0;        // distance driven to pickups
+    double driven = 0;          // distance driven in all
+    double meanTickMs = 0, maxTickMs = 0;  // matching, routing and moving
+};
+
+      // a matcher pairs idle drivers with waiting passengers: assigned[i] is the passenger index of driver i or -1
+typedef function<void(const vector<Driver>&, const vector<Passenger>&, vector<int>&)> FleetMatcher;
+
+      // the greedy matcher or the hungarian algorithm on straight line distance
+FleetMatcher fleetMatcher(bool greedy) {
+    return [greedy](const vector<Driver>& drivers, const vector<Passenger>& passengers, vector<int>& assigned) {
+        vector<int> dIndex(drivers.size()), pIndex(passengers.size());
+        for (size_t i = 0; i < dIndex.size(); ++i) dIndex[i] = i;
+        for (size_t j = 0; j < pIndex.size(); ++j) pIndex[j] = j;
+        assigned.assign(drivers.size(), -1);
+        matchGroup(drivers, passengers, dIndex, pIndex, greedy, assigned);
+    };
+}
+
+      // random numbers for the simulation, drawn straight from the generator so a seed gives the same
+      // run whatever standard library it is built with
+class FleetRandom {
+private:
+    mt19937_64 engine;
+
+public:
+    explicit FleetRandom(unsigned long long seed) : engine(seed) {}
+
+    double uniform() {
+        return (engine() >> 11) * (1.0 / 9007199254740992.0);
+    }
+    int below(int n) {
+        return (int)(uniform() * n);
+    }
+    double normal() {
+        double a = max(uniform(), 1e-300), b = uniform();
+        return sqrt(-2 * log(a)) * cos(2 * M_PI * b);
+    }
+      // count of events at the given mean rate, by multiplying uniforms below exp(-mean) in chunks of 500
+    int poisson(double mean) {
+        int count = 0;
+        while (mean > 0) {
+            double part = min(mean, 500.0), limit = exp(-part), product = uniform();
+            while (product > limit) {
+                count++;
+                product *= uniform();
+            }
+            mean -= part;
+        }
+        return count;
+    }
+};
+
+      // flat indices of the largest set of free cells A* can drive between, in increasing order
+vector<int> largestFreeArea(const vector<vector<int>>& grid, int ROW, int COL) {
+    vector<bool> seen((size_t)ROW * COL, false);
+    vector<int> largest;
+    for (int c = 0; c < ROW * COL; ++c) {
+        if (grid[c / COL][c % COL] != 1 || seen[c]) continue;
+        vector<int> reached(1, c);
+        seen[c] = true;
+        for (size_t k = 0; k < reached.size(); ++k) {
+            for (const direction& d : DIRS) {
+                int i = reached[k] / COL + d.di, j = reached[k] % COL + d.dj;
+                if (i < 0 || i >= ROW || j < 0 || j >= COL || grid[i][j] != 1 || seen[i * COL + j]) continue;
+                seen[i * COL + j] = true;
+                reached.push_back(i * COL + j);
+            }
+        }
+        if (reached.size() > largest.size()) {
+            sort(reached.begin(), reached.end());
+            largest.swap(reached);
+        }
+    }
+    return largest;
+}
+
+FleetStats simulateFleet(const vector<vector<int>>& grid, int ROW, int COL, const FleetOptions& options, const FleetMatcher& matcher,
+                         ostream& trace) {
+    FleetStats stats;
+    int threads = options.threads > 0 ? options.threads : max(1u, thread::hardware_concurrency());
+      // drivers and passengers only appear on the largest set of free cells A* can drive between
+    vector<int> freeCells = largestFreeArea(grid, ROW, COL);
+    if (freeCells.empty()) return stats;
+    vector<bool> reachable(ROW * COL, false);
+    for (int c : freeCells) reachable[c] = true;
+
+    FleetRandom random(options.seed);
+    vector<int> hotspots;
+    for (int h = 0; h < options.hotspots; ++h) hotspots.push_back(freeCells[random.below(freeCells.size())]);
+      // a free cell near a hotspot, or anywhere
+    auto drawCell = [&]() {
+        if (!hotspots.empty() && random.uniform() < options.hotspotShare) {
+            int centre = hotspots[random.below(hotspots.size())];
+            for (int attempt = 0; attempt < 20; ++attempt) {
+                int i = (int)lround(centre / COL + random.normal() * options.hotspotSpread);
+                int j = (int)lround(centre % COL + random.normal() * options.hotspotSpread);
+                if (i >= 0 && i < ROW && j >= 0 && j < COL && reachable[i * COL + j]) return i * COL + j;
+            }
+        }
+        return freeCells[random.below(freeCells.size())];
+    };
+
+    struct Request {
+        int from, to;
+        int tick;
+    };
+    struct Vehicle {
+        int cell;
+        int request = -1;       // request being served, -1 when idle
+        vector<int> route;      // cells from where the trip started through the pickup to the destination
+        size_t next = 0;        // route index of the next cell
+        size_t pickupAt = 0;    // route index of the pickup
+        bool pickedUp = false;
+        int pickupTick = -1;    // set by the tick the passenger got in, read and cleared after the move
+        bool delivered = false;
+        double deadhead = 0, driven = 0;
+    };
+    vector<Request> requests;
+    vector<Vehicle> vehicles(options.drivers);
+    for (Vehicle& v : vehicles) v.cell = freeCells[random.below(freeCells.size())];
+
+    BATCHASTAR<vector<vector<int>>> router(grid, ROW, COL, threads);
+    vector<int> waiting, waits;
+    vector<double> tickMs;
+    vector<Driver> idleDrivers;
+    vector<Passenger> open;
+    vector<int> idle, assigned;
+    vector<pair<Pair, Pair>> queries;
+    vector<PathResult> paths;
+    auto toLocation = [&](int cell) { return Location{(double)(cell / COL), (double)(cell % COL)}; };
+    auto toPair = [&](int cell) { return make_pair(cell / COL, cell % COL); };
+
+    for (int tick = 0; tick < options.ticks; ++tick) {
+          // new requests and the ones that gave up
+        double rate = options.requestRate * (1 + options.peakShare * sin(2 * M_PI * tick / max(options.dayLength, 1)));
+        int arriving = random.poisson(max(rate, 0.0));
+        for (int r = 0; r < arriving; ++r) {
+            int from = drawCell(), to = drawCell();
+            if (from == to) continue;
+            waiting.push_back(requests.size());
+            requests.push_back({from, to, tick});
+            stats.requests++;
+        }
+        size_t kept = 0;
+        for (int r : waiting) {
+            if (tick - requests[r].tick > options.patience) stats.abandoned++;
+            else waiting[kept++] = r;
+        }
+        waiting.resize(kept);
+
+          // match the idle drivers to the waiting requests
+        auto start = chrono::steady_clock::now();
+        idle.clear();
+        idleDrivers.clear();
+        for (int v = 0; v < (int)vehicles.size(); ++v) {
+            if (vehicles[v].request != -1) continue;
+            idle.push_back(v);
+            idleDrivers.push_back({v, toLocation(vehicles[v].cell), true});
+        }
+        open.clear();
+        for (int r : waiting) open.push_back({r, toLocation(requests[r].from), toLocation(requests[r].to), false});
+        assigned.assign(idle.size(), -1);
+        if (!idle.empty() && !open.empty()) matcher(idleDrivers, open, assigned);
+        int matched = 0;
+
+          // route every new trip to its pickup and on to its destination
+        queries.clear();
+        for (size_t k = 0; k < idle.size(); ++k) {
+            if (assigned[k] == -1) continue;
+            const Request& r = requests[waiting[assigned[k]]];
+            queries.push_back({toPair(vehicles[idle[k]].cell), toPair(r.from)});
+            queries.push_back({toPair(r.from), toPair(r.to)});
+        }
+        router.solve(queries, paths);
+        vector<bool> taken(waiting.size(), false);
+        size_t q = 0;
+        for (size_t k = 0; k < idle.size(); ++k) {
+            if (assigned[k] == -1) continue;
+            const PathResult& toPickup = paths[q++];
+            const PathResult& toDestination = paths[q++];
+            if (toPickup.length == 0 || toDestination.length == 0) continue;
+            taken[assigned[k]] = true;
+            Vehicle& v = vehicles[idle[k]];
+            v.request = waiting[assigned[k]];
+            v.route.assign(toPickup.cells, toPickup.cells + toPickup.length);
+            v.route.insert(v.route.end(), toDestination.cells + 1, toDestination.cells + toDestination.length);
+            v.next = 1;
+            v.pickupAt = toPickup.length - 1;
+            v.pickedUp = false;
+            matched++;
+        }
+        kept = 0;
+        for (size_t w = 0; w < waiting.size(); ++w) {
+            if (!taken[w]) waiting[kept++] = waiting[w];
+        }
+        waiting.resize(kept);
+
+          // every driver moves up to speed cells along its route, picking up and dropping off on the way
+        const int CHUNK = 64;
+        router.pool.run((vehicles.size() + CHUNK - 1) / CHUNK, [&](int, int task) {
+            for (size_t k = task * CHUNK; k < min(vehicles.size(), (size_t)(task + 1) * CHUNK); ++k) {
+                Vehicle& v = vehicles[k];
+                if (v.request == -1) continue;
+                for (int step = 0;; ++step) {
+                    if (!v.pickedUp && v.next - 1 == v.pickupAt) {
+                        v.pickedUp = true;
+                        v.pickupTick = tick;
+                    }
+                    if (v.next == v.route.size()) {
+                        v.delivered = true;
+                        break;
+                    }
+                    if (step == options.speed) break;
+                    int from = v.route[v.next - 1], to = v.route[v.next++];
+                    double length = (from / COL != to / COL && from % COL != to % COL) ? M_SQRT2 : 1;
+                    v.driven += length;
+                    if (!v.pickedUp) v.deadhead += length;
+                    v.cell = to;
+                }
+            }
+        });
+        for (Vehicle& v : vehicles) {
+            if (v.pickupTick != -1) {
+                waits.push_back(v.pickupTick - requests[v.request].tick);
+                stats.pickedUp++;
+                v.pickupTick = -1;
+            }
+            if (v.delivered) {
+                stats.completed++;
+                v.delivered = false;
+                v.request = -1;
+                v.route.clear();
+            }
+        }
+        tickMs.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+        if (options.trace) {
+            trace << "{\"type\": \"tick\", \"tick\": " << tick << ", \"requests\": " << arriving << ", \"waiting\": "
+                  << waiting.size() << ", \"idle\": " << idle.size() - matched << ", \"matched\": " << matched
+                  << ", \"ms\": " << tickMs.back() << "}\n";
+        }
+    }
+
+    for (const Vehicle& v : vehicles) {
+        stats.deadhead += v.deadhead;
+        stats.driven += v.driven;
+    }
+    if (!waits.empty()) {
+        double total = 0;
+        for (int w : waits) total += w;
+        stats.meanWait = total / waits.size();
+        sort(waits.begin(), waits.end());
+        stats.p95Wait = waits[min(waits.size() - 1, waits.size() * 95 / 100)];
+    }
+    for (double ms : tickMs) {
+        stats.meanTickMs += ms / tickMs.size();
+        stats.maxTickMs = max(stats.maxTickMs, ms);
+    }
+    return stats;
+}
+
+  // main simulation loop, with nearest > 0 the auction matches on each passenger's nearest drivers
+void simulateRideSharing(int nearest = 0, int threads = 0) {
     // examp. drivers and passengers
     vector<Driver> drivers = {
         {1, {0, 0}, true},
@@ -152,13 +2365,149 @@ void simulateRideSharing() {
     };
 
       // assign drivers to passengers
-    assignDrivers(drivers, passengers);
+    if (nearest > 0) assignNearestDrivers(drivers, passengers, nearest, threads);
+    else assignDrivers(drivers, passengers);
 
-      // after assignment, drivers move towards their passengers destinations
-      // simulate real time updates, reassign if needed
+      // after assignment, drivers move towards their passengers destinations.
+      // real time updates and reassignment are handled by runDispatcher, see --stream
 }
 
-int main() {
-    simulateRideSharing();
+  // match on road distances: drivers and passengers are given as road graph nodes,
+  // a count of drivers and their nodes followed by a count of passengers and their nodes
+void simulateRoadRideSharing(CHManyToMany& roads) {
+    vector<Driver> drivers;
+    vector<Passenger> passengers;
+    int count, node;
+    cin >> count;
+    for (int i = 0; i < count && cin >> node; ++i) {
+        Driver driver = {i + 1, {0, 0}, true};
+        driver.location.node = node;
+        drivers.push_back(driver);
+    }
+    cin >> count;
+    for (int i = 0; i < count && cin >> node; ++i) {
+        Passenger passenger = {i + 1, {0, 0}, {0, 0}, false};
+        passenger.location.node = node;
+        passengers.push_back(passenger);
+    }
+    for (const Driver& d : drivers) {
+        if (d.location.node < 0 || d.location.node >= roads.ch.n) {
+            cout << "driver node " << d.location.node << " is not on the road graph" << endl;
+            return;
+        }
+    }
+    for (const Passenger& p : passengers) {
+        if (p.location.node < 0 || p.location.node >= roads.ch.n) {
+            cout << "passenger node " << p.location.node << " is not on the road graph" << endl;
+            return;
+        }
+    }
+    assignDrivers(drivers, passengers, &roads);
+}
+
+#ifdef OPTIRIDE_HUNGARIAN_MAIN
+  // pass --roads FILE to load a contraction hierarchy saved by dIjkstra_algo --save-ch
+  // and match drivers and passengers read from input on road distances.
+  // pass --auction K to match with the auction on each passenger's K nearest drivers, --threads N for its threads.
+  // pass --zones Z to match drivers and passengers read from input zone by zone on a pool of threads and compare
+  // with a global solve, --greedy to use the greedy matcher instead of the hungarian algorithm for it.
+  // pass --stream to run the dispatcher on JSON line events from input, --window MS and --batch N bound
+  // its micro batches and --greedy picks the greedy matcher.
+  // pass --pool C to pool passengers read from input with their destinations into vehicles of C seats,
+  // --wait W and --detour F set the latest pickup and the longest detour as a fraction of the direct ride.
+  // pass --simulate TICKS to run the fleet simulation for that many ticks on a grid map read from input as
+  // A_STAR_SEARCH_ALGORITHM reads it, ROW COL and the cells, 1 free and 0 blocked. --drivers N, --rate R
+  // requests per tick and --seed S set it up, --greedy picks the greedy matcher and --trace prints every tick.
+  // pass --churn ROUNDS to stress the driver registry with --threads N writers and check it after every round
+int main(int argc, char** argv) {
+    string roadsFile;
+    int nearest = 0, threads = 0, zones = 0;
+    bool greedy = false, stream = false;
+    DispatchOptions dispatch;
+    PoolingOptions pooling;
+    bool pool = false;
+    FleetOptions fleet;
+    bool simulate = false;
+    int churn = 0;
+    for (int a = 1; a < argc; a++) {
+        if (string(argv[a]) == "--roads" && a + 1 < argc) roadsFile = argv[++a];
+        else if (string(argv[a]) == "--auction" && a + 1 < argc) nearest = atoi(argv[++a]);
+        else if (string(argv[a]) == "--threads" && a + 1 < argc) threads = atoi(argv[++a]);
+        else if (string(argv[a]) == "--zones" && a + 1 < argc) zones = atoi(argv[++a]);
+        else if (string(argv[a]) == "--greedy") greedy = true;
+        else if (string(argv[a]) == "--stream") stream = true;
+        else if (string(argv[a]) == "--window" && a + 1 < argc) dispatch.windowMs = atof(argv[++a]);
+        else if (string(argv[a]) == "--batch" && a + 1 < argc) dispatch.batchSize = max(1, atoi(argv[++a]));
+        else if (string(argv[a]) == "--pool" && a + 1 < argc) {
+            pool = true;
+            pooling.capacity = max(1, atoi(argv[++a]));
+        }
+        else if (string(argv[a]) == "--wait" && a + 1 < argc) pooling.maxWait = atof(argv[++a]);
+        else if (string(argv[a]) == "--detour" && a + 1 < argc) pooling.maxDetour = atof(argv[++a]);
+        else if (string(argv[a]) == "--simulate" && a + 1 < argc) {
+            simulate = true;
+            fleet.ticks = atoi(argv[++a]);
+        }
+        else if (string(argv[a]) == "--drivers" && a + 1 < argc) fleet.drivers = max(0, atoi(argv[++a]));
+        else if (string(argv[a]) == "--rate" && a + 1 < argc) fleet.requestRate = atof(argv[++a]);
+        else if (string(argv[a]) == "--seed" && a + 1 < argc) fleet.seed = strtoull(argv[++a], nullptr, 10);
+        else if (string(argv[a]) == "--trace") fleet.trace = true;
+        else if (string(argv[a]) == "--churn" && a + 1 < argc) churn = max(1, atoi(argv[++a]));
+    }
+    if (churn > 0) {
+        int writers = threads > 0 ? threads : 4, operations = 200;
+        int broken = churnRegistry(churn, writers, operations, fleet.seed);
+        cout << "{\"type\": \"churn\", \"rounds\": " << churn << ", \"writers\": " << writers << ", \"operations\": "
+             << (long long)churn * writers * operations << ", \"failed\": " << broken << "}" << endl;
+        return broken == 0 ? 0 : 1;
+    }
+    if (stream) {
+        dispatch.greedy = greedy;
+        DispatchStats stats = runDispatcher(cin, cout, dispatch);
+        cout << "{\"type\": \"summary\", \"events\": " << stats.events << ", \"skipped\": " << stats.skipped
+             << ", \"batches\": " << stats.batches << ", \"assignments\": " << stats.assignments
+             << ", \"dropped\": " << stats.dropped << ", \"waiting\": " << stats.waiting
+             << ", \"solve_ms\": " << stats.solveMs << "}" << endl;
+        return 0;
+    }
+    if (simulate) {
+        int ROW = 0, COL = 0;
+        cin >> ROW >> COL;
+        vector<vector<int>> grid(max(ROW, 0), vector<int>(max(COL, 0), 0));
+        for (auto& line : grid) {
+            for (int& c : line) cin >> c;
+        }
+        fleet.threads = threads;
+        FleetStats stats = simulateFleet(grid, ROW, COL, fleet, fleetMatcher(greedy), cout);
+        cout << "{\"type\": \"fleet\", \"matcher\": \"" << (greedy ? "greedy" : "hungarian") << "\", \"seed\": " << fleet.seed
+             << ", \"ticks\": " << fleet.ticks << ", \"drivers\": " << fleet.drivers << ", \"requests\": " << stats.requests
+             << ", \"picked_up\": " << stats.pickedUp << ", \"completed\": " << stats.completed << ", \"abandoned\": " << stats.abandoned
+             << ", \"mean_wait\": " << stats.meanWait << ", \"p95_wait\": " << stats.p95Wait
+             << ", \"deadhead\": " << stats.deadhead << ", \"driven\": " << stats.driven << ", \"mean_tick_ms\": " << stats.meanTickMs
+             << ", \"max_tick_ms\": " << stats.maxTickMs << "}" << endl;
+        return 0;
+    }
+    if (pool) {
+        pooling.threads = threads;
+        pooling.maxGroup = min(pooling.maxGroup, pooling.capacity);
+        simulatePooling(pooling);
+        return 0;
+    }
+    if (zones > 0) {
+        simulateZoneMatching(zones, greedy, threads);
+        return 0;
+    }
+    if (!roadsFile.empty()) {
+        ContractionHierarchy ch;
+        if (!ch.load(roadsFile)) {
+            cout << "cannot load a contraction hierarchy from " << roadsFile << endl;
+            return 1;
+        }
+        CHManyToMany roads(ch);
+        simulateRoadRideSharing(roads);
+        return 0;
+    }
+    simulateRideSharing(nearest, threads);
     return 0;
 }
+#endif